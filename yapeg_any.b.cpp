@@ -0,0 +1,126 @@
+#include <yapeg_bench.h>
+#include <yapeg_any.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace yapeg {
+
+namespace {
+
+using Token = std::pair<std::string, std::string>;
+
+const std::size_t k_OPS = 10000;
+    
+template<typename T>
+void benchSetGet(bench::Counters& counters, const T& value)
+{
+    Any a;
+    for(std::size_t i = 0; i < k_OPS; ++i)
+    {
+        a.set(value);
+        bench::keep(a.get<T>());
+    }
+    counters.d_items += k_OPS;
+}
+
+// Round trip through the Any, copying in and out as capture does.
+template<typename T>
+void benchSetCopy(bench::Counters& counters, const T& value)
+{
+    Any a;
+    T out(value);
+    for(std::size_t i = 0; i < k_OPS; ++i)
+    {
+        a.set(out);
+        out = a.get<T>();
+    }
+    bench::keep(out);
+    counters.d_items += k_OPS;
+}
+
+// Same round trip, moving in and out as captureMove does.
+template<typename T>
+void benchSetTake(bench::Counters& counters, const T& value)
+{
+    Any a;
+    T out(value);
+    for(std::size_t i = 0; i < k_OPS; ++i)
+    {
+        a.set(std::move(out));
+        out = a.take<T>();
+    }
+    bench::keep(out);
+    counters.d_items += k_OPS;
+}
+
+template<typename T>
+void benchCopy(bench::Counters& counters, const T& value)
+{
+    Any a;
+    a.set(value);
+    for(std::size_t i = 0; i < k_OPS; ++i)
+    {
+        Any b(a);
+        bench::keep(b);
+    }
+    counters.d_items += k_OPS;
+}
+
+template<typename T>
+void benchMove(bench::Counters& counters, const T& value)
+{
+    Any a;
+    a.set(value);
+    for(std::size_t i = 0; i < k_OPS; ++i)
+    {
+        Any b(std::move(a));
+        a = std::move(b);
+    }
+    bench::keep(a);
+    counters.d_items += 2 * k_OPS;
+}
+
+const Token k_TOKEN("ident", "value");
+const std::vector<Token> k_TOKENS(8, k_TOKEN);
+    
+bench::Registrar s_setInt(
+    "any/set_get/int",
+    [](bench::Counters& c) { benchSetGet(c, 42); });
+bench::Registrar s_setToken(
+    "any/set_get/token",
+    [](bench::Counters& c) { benchSetGet(c, k_TOKEN); });
+bench::Registrar s_setVector(
+    "any/set_get/vector",
+    [](bench::Counters& c) { benchSetGet(c, k_TOKENS); });
+bench::Registrar s_setCopyVector(
+    "any/set_copy/vector",
+    [](bench::Counters& c) { benchSetCopy(c, k_TOKENS); });
+bench::Registrar s_setTakeToken(
+    "any/set_take/token",
+    [](bench::Counters& c) { benchSetTake(c, k_TOKEN); });
+bench::Registrar s_setTakeVector(
+    "any/set_take/vector",
+    [](bench::Counters& c) { benchSetTake(c, k_TOKENS); });
+bench::Registrar s_copyInt(
+    "any/copy/int",
+    [](bench::Counters& c) { benchCopy(c, 42); });
+bench::Registrar s_copyToken(
+    "any/copy/token",
+    [](bench::Counters& c) { benchCopy(c, k_TOKEN); });
+bench::Registrar s_copyVector(
+    "any/copy/vector",
+    [](bench::Counters& c) { benchCopy(c, k_TOKENS); });
+bench::Registrar s_moveInt(
+    "any/move/int",
+    [](bench::Counters& c) { benchMove(c, 42); });
+bench::Registrar s_moveToken(
+    "any/move/token",
+    [](bench::Counters& c) { benchMove(c, k_TOKEN); });
+bench::Registrar s_moveVector(
+    "any/move/vector",
+    [](bench::Counters& c) { benchMove(c, k_TOKENS); });
+    
+} // close anonymous namespace
+    
+} // close namespace yapeg
@@ -4,6 +4,13 @@ namespace yapeg {
 
 // CREATORS
 Any::Any()
+    : d_arena(0)
+{
+    resetNone();
+}
+
+Any::Any(Arena* arena)
+    : d_arena(arena)
 {
     resetNone();
 }
@@ -16,23 +23,35 @@ Any::~Any()
 Any::Any(Any&& other)
     : d_typeInfo(other.d_typeInfo)
     , d_typeCategory(other.d_typeCategory)
-    , d_data(other.d_data)
-    , d_deleteFunc(other.d_deleteFunc)
-    , d_cloneFunc(other.d_cloneFunc)
+    , d_ops(other.d_ops)
+    , d_arena(other.d_arena)
+    , d_dataArena(other.d_dataArena)
 {
+    if(other.isObj())
+    {
+        d_ops->d_move(other.d_data, d_data);
+    }
+    else
+    {
+        d_data = other.d_data;
+    }
     other.resetNone();
 }
     
 Any::Any(const Any& other)
     : d_typeInfo(other.d_typeInfo)
     , d_typeCategory(other.d_typeCategory)
-    , d_data(other.d_data)
-    , d_deleteFunc(other.d_deleteFunc)
-    , d_cloneFunc(other.d_cloneFunc)
+    , d_ops(other.d_ops)
+    , d_arena(0)
+    , d_dataArena(0)
 {
     if(other.isObj())
     {
-        d_data.p = other.clone();
+        d_ops->d_copy(other.d_data, d_data, d_arena);
+    }
+    else
+    {
+        d_data = other.d_data;
     }
 }
 
@@ -44,9 +63,16 @@ Any& Any::operator= (Any&& rhs)
         destroy();
         d_typeInfo = rhs.d_typeInfo;
         d_typeCategory = rhs.d_typeCategory;
-        d_data = rhs.d_data;
-        d_deleteFunc = rhs.d_deleteFunc;
-        d_cloneFunc = rhs.d_cloneFunc;
+        d_ops = rhs.d_ops;
+        d_dataArena = rhs.d_dataArena;
+        if(rhs.isObj())
+        {
+            d_ops->d_move(rhs.d_data, d_data);
+        }
+        else
+        {
+            d_data = rhs.d_data;
+        }
         rhs.resetNone();
     }
     return *this;
@@ -56,8 +82,22 @@ Any& Any::operator= (const Any& rhs)
 {
     if(this != &rhs)
     {
-        Any tmp(rhs);
-        operator=(std::move(tmp));
+        if(rhs.isObj())
+        {
+            Storage tmp;
+            rhs.d_ops->d_copy(rhs.d_data, tmp, d_arena);
+            destroy();
+            rhs.d_ops->d_move(tmp, d_data);
+            d_dataArena = d_arena;
+        }
+        else
+        {
+            destroy();
+            d_data = rhs.d_data;
+        }
+        d_typeInfo = rhs.d_typeInfo;
+        d_typeCategory = rhs.d_typeCategory;
+        d_ops = rhs.d_ops;
     }
     return *this;
 }
@@ -66,18 +106,17 @@ void Any::resetNone()
 {
     d_typeInfo = 0;
     d_typeCategory = TypeCategory::NONE;
-    d_data.p = 0;
-    d_deleteFunc = 0;
-    d_cloneFunc = 0;
+    d_ops = 0;
+    d_dataArena = 0;
 }
 
 void Any::destroy()
 {
     if(isObj())
     {
-        assert(d_deleteFunc);
-        d_deleteFunc(d_data.p);
-        d_data.p = 0;
+        assert(d_ops);
+        d_ops->d_destroy(d_data, d_dataArena);
+        d_typeCategory = TypeCategory::NONE;
     }
 }
 
@@ -85,8 +124,7 @@ void Any::setSimpleCommon()
 {
     destroy();
     d_typeCategory = TypeCategory::SIMPLE;
-    d_deleteFunc = 0;
-    d_cloneFunc = 0;
+    d_ops = 0;
 }
     
 void Any::clear()
@@ -95,11 +133,4 @@ void Any::clear()
     resetNone();
 }
 
-// ACCESSORS
-void* Any::clone() const
-{
-    assert(isObj() && d_cloneFunc);
-    return d_cloneFunc(d_data.p);
-}
-
 } // close namespace yapeg
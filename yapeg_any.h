@@ -1,36 +1,126 @@
 #ifndef INCLUDED_YAPEG_ANY_H
 #define INCLUDED_YAPEG_ANY_H
 
+#include <yapeg_arena.h>
+#include <cstddef>
+#include <new>
 #include <utility>
 #include <typeinfo>
 #include <type_traits>
 #include <exception>
 #include <cassert>
 
+// Objects up to this many bytes (and with a nothrow move constructor) are
+// stored inside the Any itself instead of on the heap.
+#ifndef YAPEG_ANY_INLINE_SIZE
+#define YAPEG_ANY_INLINE_SIZE 64
+#endif
+
 namespace yapeg {
 
 namespace any_impl {
+
+using Storage =
+    std::aligned_storage<YAPEG_ANY_INLINE_SIZE,
+                         alignof(std::max_align_t)>::type;
     
+// Fundamental and pointer types are simple: stored inline, copied
+// bitwise and returned by value.
 template<typename T>
-struct IsObj: public std::true_type {};
-template<>
-struct IsObj<char>: public std::false_type {};
-template<>
-struct IsObj<short>: public std::false_type {};
-template<>
-struct IsObj<unsigned short>: public std::false_type {};
-template<>
-struct IsObj<int>: public std::false_type {};
-template<>
-struct IsObj<unsigned int>: public std::false_type {};
-template<>
-struct IsObj<float>: public std::false_type {};
-template<>
-struct IsObj<double>: public std::false_type {};
-template<>
-struct IsObj<long long>: public std::false_type {};
-template<>
-struct IsObj<unsigned long long>: public std::false_type {};
+struct IsObj: public std::integral_constant<
+    bool,
+    !std::is_fundamental<T>::value && !std::is_pointer<T>::value> {};
+
+template<typename T>
+struct IsInline: public std::integral_constant<
+    bool,
+    sizeof(T) <= sizeof(Storage) &&
+    alignof(T) <= alignof(Storage) &&
+    std::is_nothrow_move_constructible<T>::value> {};
+
+// Heap objects are allocated from 'arena' when one is given.
+struct ObjOps
+{
+    void (*d_destroy)(Storage&, Arena*);
+    void (*d_copy)(const Storage&, Storage&, Arena*);
+    void (*d_move)(Storage&, Storage&);
+};
+    
+template<typename T, bool INLINE = IsInline<T>::value>
+struct ObjOpsT
+{
+    static T* ptr(Storage& s)
+    { return reinterpret_cast<T*>(&s); }
+
+    static const T* ptr(const Storage& s)
+    { return reinterpret_cast<const T*>(&s); }
+    
+    template<typename... Args>
+    static void create(Storage& s, Arena*, Args&&... args)
+    { new (&s) T(std::forward<Args>(args)...); }
+    
+    static void destroy(Storage& s, Arena*)
+    { ptr(s)->~T(); }
+
+    static void copy(const Storage& from, Storage& to, Arena*)
+    { new (&to) T(*ptr(from)); }
+
+    static void move(Storage& from, Storage& to)
+    {
+        new (&to) T(std::move(*ptr(from)));
+        ptr(from)->~T();
+    }
+
+    static const ObjOps* ops()
+    {
+        static const ObjOps s_ops = { &destroy, &copy, &move };
+        return &s_ops;
+    }
+};
+
+template<typename T>
+struct ObjOpsT<T, false>
+{
+    static T* ptr(Storage& s)
+    { return *reinterpret_cast<T**>(&s); }
+
+    static const T* ptr(const Storage& s)
+    { return *reinterpret_cast<T* const*>(&s); }
+    
+    template<typename... Args>
+    static void create(Storage& s, Arena* arena, Args&&... args)
+    {
+        T* p;
+        if(arena)
+        {
+            p = new (arena->allocate(sizeof(T), alignof(T)))
+                T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            p = new T(std::forward<Args>(args)...);
+        }
+        *reinterpret_cast<T**>(&s) = p;
+    }
+    
+    static void destroy(Storage& s, Arena* arena)
+    {
+        if(arena) ptr(s)->~T();
+        else delete ptr(s);
+    }
+
+    static void copy(const Storage& from, Storage& to, Arena* arena)
+    { create(to, arena, *ptr(from)); }
+
+    static void move(Storage& from, Storage& to)
+    { *reinterpret_cast<T**>(&to) = ptr(from); }
+
+    static const ObjOps* ops()
+    {
+        static const ObjOps s_ops = { &destroy, &copy, &move };
+        return &s_ops;
+    }
+};
     
 } // close namespace any_impl
     
@@ -42,61 +132,43 @@ public:
     
 private:
     // TYPES
-    using DeleteFunc = void(*)(void*);
-    using CloneFunc = void*(*)(void*);
+    using Storage = any_impl::Storage;
     enum class TypeCategory { NONE, SIMPLE, OBJ };
 
     // DATA
     const std::type_info* d_typeInfo;
     TypeCategory d_typeCategory;
-    union
-    {
-        char c;
-        short s;
-        unsigned short us;
-        int i;
-        unsigned int ui;
-        float f;
-        double d;
-        long long ll;
-        unsigned long long ull;
-        void* p;
-    } d_data;
-    DeleteFunc d_deleteFunc;
-    CloneFunc d_cloneFunc;
+    Storage d_data;
+    const any_impl::ObjOps* d_ops;
+    Arena* d_arena;      // allocates new heap objects, 0 for new/delete
+    Arena* d_dataArena;  // holds the current heap object
 
 private:
-    // CLASS METHODS
-    template<typename T>
-    static void deleteT(void* p)
-    {
-        if(p) delete static_cast<T*>(p);
-    }
-
-    template<typename T>
-    static void* cloneT(void* p)
-    {
-        assert(p);
-        T* tp = new T(*(static_cast<T*>(p)));
-        assert(tp);
-        return tp;
-    }
-    
     // MANIPULATORS
     void resetNone();
     void destroy();
     void setSimpleCommon();
 
-    template<typename T>
-    void setObjCommon(void* p)
+    template<typename T, typename... Args>
+    void setObjCommon(Args&&... args)
     {
-        assert(p);
-        destroy();
+        using Ops = any_impl::ObjOpsT<T>;
+        if(isObj())
+        {
+            // 'args' may refer into the current value
+            Storage tmp;
+            Ops::create(tmp, d_arena, std::forward<Args>(args)...);
+            destroy();
+            Ops::move(tmp, d_data);
+        }
+        else
+        {
+            Ops::create(d_data, d_arena, std::forward<Args>(args)...);
+        }
         setTypeInfo<T>();
         d_typeCategory = TypeCategory::OBJ;
-        d_data.p = p;
-        d_deleteFunc = &deleteT<T>;
-        d_cloneFunc = &cloneT<T>;
+        d_ops = Ops::ops();
+        d_dataArena = d_arena;
     }
     
     template<typename T>
@@ -107,8 +179,6 @@ private:
     }
 
     // ACCESSORS
-    void* clone() const;
-    
     template<typename T>
     void checkTypeInfo() const
     {
@@ -118,6 +188,9 @@ private:
 public:
     // CREATORS
     Any();
+    // Heap objects set into this Any are allocated from 'arena', which
+    // must outlive the value.  Moves keep the arena, copies do not.
+    explicit Any(Arena* arena);
     ~Any();
     Any(Any&& other);
     Any(const Any& other);
@@ -129,184 +202,76 @@ public:
     void clear();
 
     template<typename T>
-    typename std::enable_if<std::is_same<T,char>::value, void>::type
-    set(T t)
-    {
-        setTypeInfo<T>();
-        setSimpleCommon();
-        d_data.c = t;
-    }
-
-    template<typename T>
-    typename std::enable_if<std::is_same<T,short>::value, void>::type
-    set(T t)
-    {
-        setTypeInfo<T>();
-        setSimpleCommon();
-        d_data.s = t;
-    }
-
-    template<typename T>
-    typename std::enable_if<std::is_same<T,unsigned short>::value, void>::type
-    set(T t)
-    {
-        setTypeInfo<T>();
-        setSimpleCommon();
-        d_data.us = t;
-    }
-
-    template<typename T>
-    typename std::enable_if<std::is_same<T,int>::value, void>::type
-    set(T t)
-    {
-        setTypeInfo<T>();
-        setSimpleCommon();
-        d_data.i = t;
-    }
-    
-    template<typename T>
-    typename std::enable_if<std::is_same<T,unsigned int>::value, void>::type
-    set(T t)
-    {
-        setTypeInfo<T>();
-        setSimpleCommon();
-        d_data.ui = t;
-    }
-
-    template<typename T>
-    typename std::enable_if<std::is_same<T,float>::value, void>::type
+    typename std::enable_if<!any_impl::IsObj<T>::value, void>::type
     set(T t)
     {
-        setTypeInfo<T>();
         setSimpleCommon();
-        d_data.f = t;
-    }
-
-    template<typename T>
-    typename std::enable_if<std::is_same<T,double>::value, void>::type
-    set(T t)
-    {
         setTypeInfo<T>();
-        setSimpleCommon();
-        d_data.d = t;
+        new (&d_data) T(t);
     }
 
     template<typename T>
-    typename std::enable_if<std::is_same<T,long long>::value, void>::type
-    set(T t)
-    {
-        setTypeInfo<T>();
-        setSimpleCommon();
-        d_data.ll = t;
-    }
-
-    template<typename T>
-    typename std::enable_if<std::is_same<T,unsigned long long>::value, void>::type
-    set(T t)
-    {
-        setTypeInfo<T>();
-        setSimpleCommon();
-        d_data.ull = t;
-    }
-
-    template<typename T>
-    typename std::enable_if<any_impl::IsObj<T>::value, void>::type
+    typename std::enable_if<
+        any_impl::IsObj<typename std::decay<T>::type>::value, void>::type
     set(T&& t)
-    {  
-        using RT =
-            typename std::remove_cv<
-                typename std::remove_reference<T>::type>::type;
-        setObjCommon<RT>(new RT(std::forward<T>(t)));
-    }
-
-    // ACCESSORS
-    template<typename T>
-    typename std::enable_if<std::is_same<T,char>::value, T>::type
-    get() const
-    {
-        checkTypeInfo<T>();
-        assert(isSimple());
-        return d_data.c;
-    }
-
-    template<typename T>
-    typename std::enable_if<std::is_same<T,short>::value, T>::type
-    get() const
     {
-        checkTypeInfo<T>();
-        assert(isSimple());
-        return d_data.s;
+        using RT = typename std::decay<T>::type;
+        setObjCommon<RT>(std::forward<T>(t));
     }
 
-    template<typename T>
-    typename std::enable_if<std::is_same<T,unsigned short>::value, T>::type
-    get() const
+    // Construct a T from 'args' in place.
+    template<typename T, typename... Args>
+    typename std::enable_if<!any_impl::IsObj<T>::value, void>::type
+    emplace(Args&&... args)
     {
-        checkTypeInfo<T>();
-        assert(isSimple());
-        return d_data.us;
-    }
-    
-    template<typename T>
-    typename std::enable_if<std::is_same<T,int>::value, T>::type
-    get() const
-    {
-        checkTypeInfo<T>();
-        assert(isSimple());
-        return d_data.i;
+        set<T>(T(std::forward<Args>(args)...));
     }
 
-    template<typename T>
-    typename std::enable_if<std::is_same<T,unsigned int>::value, T>::type
-    get() const
+    template<typename T, typename... Args>
+    typename std::enable_if<any_impl::IsObj<T>::value, void>::type
+    emplace(Args&&... args)
     {
-        checkTypeInfo<T>();
-        assert(isSimple());
-        return d_data.ui;
+        setObjCommon<T>(std::forward<Args>(args)...);
     }
-    
-    template<typename T>
-    typename std::enable_if<std::is_same<T,float>::value, T>::type
-    get() const
-    {
-        checkTypeInfo<T>();
-        assert(isSimple());
-        return d_data.f;
-    }    
 
+    // Return the value, moved out for objects, and leave this Any empty.
     template<typename T>
-    typename std::enable_if<std::is_same<T,double>::value, T>::type
-    get() const
+    typename std::enable_if<!any_impl::IsObj<T>::value, T>::type
+    take()
     {
-        checkTypeInfo<T>();
-        assert(isSimple());
-        return d_data.d;
+        T t = get<T>();
+        clear();
+        return t;
     }
 
     template<typename T>
-    typename std::enable_if<std::is_same<T,long long>::value, T>::type
-    get() const
+    typename std::enable_if<any_impl::IsObj<T>::value, T>::type
+    take()
     {
         checkTypeInfo<T>();
-        assert(isSimple());
-        return d_data.ll;
+        assert(isObj());
+        T t(std::move(*any_impl::ObjOpsT<T>::ptr(d_data)));
+        clear();
+        return t;
     }
 
+    // ACCESSORS
     template<typename T>
-    typename std::enable_if<std::is_same<T,unsigned long long>::value, T>::type
+    typename std::enable_if<!any_impl::IsObj<T>::value, T>::type
     get() const
     {
         checkTypeInfo<T>();
         assert(isSimple());
-        return d_data.ull;
+        return *reinterpret_cast<const T*>(&d_data);
     }
     
     template<typename T>
     typename std::enable_if<any_impl::IsObj<T>::value, const T&>::type
     get() const
     {
-        assert(isObj() && d_data.p);
-        return *static_cast<T*>(d_data.p);
+        checkTypeInfo<T>();
+        assert(isObj());
+        return *any_impl::ObjOpsT<T>::ptr(d_data);
     }
 
     template<typename T>
@@ -321,6 +286,9 @@ public:
     
     bool isObj() const
     { return TypeCategory::OBJ == d_typeCategory; }
+
+    Arena* arena() const
+    { return d_arena; }
 };
 
 } // close namespace yapeg
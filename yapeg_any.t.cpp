@@ -2,6 +2,8 @@
 #include <yapeg_any.h>
 #include <memory>
 #include <utility>
+#include <string>
+#include <vector>
 
 namespace yapeg {
 
@@ -114,5 +116,116 @@ TEST(Any, set_get_4)
     a.set(foo);
 }
     
-} // close namespace yapeg
+TEST(Any, set_get_scalars)
+{
+    int i = 3;
+    const char* str = "abc";
+    
+    Any a;
+    a.set(true);
+    EXPECT_TRUE(a.isSimple());
+    EXPECT_EQ(a.get<bool>(), true);
+    a.set<long>(-5l);
+    EXPECT_EQ(a.get<long>(), -5l);
+    a.set<unsigned long>(5ul);
+    EXPECT_EQ(a.get<unsigned long>(), 5ul);
+    a.set<long double>(1.5l);
+    EXPECT_EQ(a.get<long double>(), 1.5l);
+    a.set(&i);
+    EXPECT_TRUE(a.isSimple());
+    EXPECT_EQ(a.get<int*>(), &i);
+    a.set(str);
+    EXPECT_EQ(a.get<const char*>(), str);
+    EXPECT_THROW(a.get<char*>(), Any::TypeMismatch);
+}
+
+TEST(Any, inline_obj)
+{
+    using Token = std::pair<std::string, std::string>;
+    EXPECT_TRUE(any_impl::IsInline<Token>::value);
+    
+    Any a;
+    a.set(Token("int", "123"));
+    EXPECT_TRUE(a.isObj());
+    EXPECT_EQ(a.get<Token>(), Token("int", "123"));
+    EXPECT_THROW(a.get<std::string>(), Any::TypeMismatch);
+
+    Any b(a);
+    EXPECT_EQ(b.get<Token>(), Token("int", "123"));
+
+    Any c(std::move(a));
+    EXPECT_TRUE(a.isNone());
+    EXPECT_EQ(c.get<Token>(), Token("int", "123"));
+
+    c.set(c.get<Token>().second);
+    EXPECT_EQ(c.get<std::string>(), "123");
+    
+    c = b;
+    EXPECT_EQ(c.get<Token>(), Token("int", "123"));
+    c.set<int>(1);
+    EXPECT_EQ(c.get<int>(), 1);
+}
+
+TEST(Any, heap_obj)
+{
+    struct Big
+    {
+        char d_bytes[YAPEG_ANY_INLINE_SIZE + 1];
+        std::vector<std::string> d_names;
+    };
+    EXPECT_FALSE(any_impl::IsInline<Big>::value);
 
+    Big big;
+    big.d_names.push_back("x");
+    
+    Any a;
+    a.set(big);
+    EXPECT_EQ(a.get<Big>().d_names.size(), 1u);
+
+    Any b(a);
+    EXPECT_NE(&a.get<Big>(), &b.get<Big>());
+    EXPECT_EQ(b.get<Big>().d_names[0], "x");
+    
+    const Big* p = &a.get<Big>();
+    Any c(std::move(a));
+    EXPECT_EQ(&c.get<Big>(), p);
+
+    c.set(c.get<Big>().d_names);
+    EXPECT_EQ(c.get<std::vector<std::string> >()[0], "x");
+}
+
+TEST(Any, emplace_take)
+{
+    using Names = std::vector<std::string>;
+    Any a;
+    a.emplace<int>(7);
+    EXPECT_EQ(a.take<int>(), 7);
+    EXPECT_TRUE(a.isNone());
+
+    a.emplace<Foo>(3);
+    EXPECT_EQ(a.get<Foo>(), Foo(3));
+    EXPECT_THROW(a.take<int>(), Any::TypeMismatch);
+    EXPECT_EQ(a.take<Foo>(), Foo(3));
+    EXPECT_TRUE(a.isNone());
+
+    a.emplace<Names>(100u, "name");
+    const std::string* first = &a.get<Names>()[0];
+    Names names = a.take<Names>();
+    EXPECT_TRUE(a.isNone());
+    EXPECT_EQ(names.size(), 100u);
+    EXPECT_EQ(&names[0], first);
+
+    // arguments may refer into the current value
+    a.emplace<std::string>("abc");
+    a.emplace<std::string>(a.get<std::string>(), 1u);
+    EXPECT_EQ(a.get<std::string>(), "bc");
+
+    Arena arena;
+    Any b(&arena);
+    b.emplace<Names>(100u, "name");
+    names = b.take<Names>();
+    EXPECT_TRUE(b.isNone());
+    EXPECT_EQ(names.back(), "name");
+}
+    
+} // close namespace yapeg
@@ -0,0 +1,70 @@
+#include <yapeg_arena.h>
+#include <cstdlib>
+#include <new>
+
+namespace yapeg {
+
+// CREATORS
+Arena::Arena(std::size_t blockSize)
+    : d_head(0)
+    , d_cursor(0)
+    , d_end(0)
+    , d_blockSize(blockSize)
+{
+}
+
+Arena::~Arena()
+{
+    while(d_head)
+    {
+        Block* next = d_head->d_next;
+        std::free(d_head);
+        d_head = next;
+    }
+}
+
+// MANIPULATORS
+void Arena::grow(std::size_t size, std::size_t alignment)
+{
+    std::size_t blockSize = d_head ? 2 * d_head->d_size : d_blockSize;
+    std::size_t needed = sizeof(Block) + size + alignment;
+    if(blockSize < needed)
+    {
+        blockSize = needed;
+    }
+    Block* block = static_cast<Block*>(std::malloc(blockSize));
+    if(!block) throw std::bad_alloc();
+    block->d_next = d_head;
+    block->d_size = blockSize;
+    d_head = block;
+    d_cursor = reinterpret_cast<char*>(block + 1);
+    d_end = reinterpret_cast<char*>(block) + blockSize;
+}
+
+void Arena::release()
+{
+    if(!d_head) return;
+    Block* block = d_head->d_next;
+    while(block)
+    {
+        Block* next = block->d_next;
+        std::free(block);
+        block = next;
+    }
+    d_head->d_next = 0;
+    d_cursor = reinterpret_cast<char*>(d_head + 1);
+    d_end = reinterpret_cast<char*>(d_head) + d_head->d_size;
+}
+
+// ACCESSORS
+std::size_t Arena::capacity() const
+{
+    std::size_t total = 0;
+    for(const Block* block = d_head; block; block = block->d_next)
+    {
+        total += block->d_size;
+    }
+    return total;
+}
+    
+} // close namespace yapeg
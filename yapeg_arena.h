@@ -0,0 +1,66 @@
+#ifndef INCLUDED_YAPEG_ARENA_H
+#define INCLUDED_YAPEG_ARENA_H
+
+#include <cstddef>
+
+namespace yapeg {
+
+// Bump allocator: memory is handed out from large blocks and only given
+// back all at once by release().  Objects placed in an Arena must be
+// destroyed by their owner before release(); the Arena never runs
+// destructors.
+class Arena
+{
+private:
+    // TYPES
+    struct Block
+    {
+        Block* d_next;
+        std::size_t d_size;
+    };
+
+    // DATA
+    Block* d_head;
+    char* d_cursor;
+    char* d_end;
+    std::size_t d_blockSize;
+
+private:
+    // MANIPULATORS
+    void grow(std::size_t size, std::size_t alignment);
+    
+public:
+    // CREATORS
+    explicit Arena(std::size_t blockSize = 4096);
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator= (const Arena&) = delete;
+
+    // MANIPULATORS
+    void* allocate(std::size_t size,
+                   std::size_t alignment = alignof(std::max_align_t))
+    {
+        std::size_t pad =
+            (alignment - reinterpret_cast<std::size_t>(d_cursor)) &
+            (alignment - 1);
+        if(static_cast<std::size_t>(d_end - d_cursor) < pad + size)
+        {
+            grow(size, alignment);
+            return allocate(size, alignment);
+        }
+        char* p = d_cursor + pad;
+        d_cursor = p + size;
+        return p;
+    }
+
+    // Make all allocated memory available again.  The newest (largest)
+    // block is kept for reuse, all others are freed.
+    void release();
+
+    // ACCESSORS
+    std::size_t capacity() const;
+};
+    
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_ARENA_H
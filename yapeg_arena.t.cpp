@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <yapeg_arena.h>
+#include <yapeg_any.h>
+#include <yapeg_combinators.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+TEST(Arena, allocate)
+{
+    Arena arena(256);
+    EXPECT_EQ(arena.capacity(), 0u);
+
+    char* a = static_cast<char*>(arena.allocate(3, 1));
+    char* b = static_cast<char*>(arena.allocate(8, 8));
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(b) % 8, 0u);
+    EXPECT_GE(b, a + 3);
+    EXPECT_EQ(arena.capacity(), 256u);
+    
+    void* big = arena.allocate(1000);
+    EXPECT_NE(big, nullptr);
+    EXPECT_GE(arena.capacity(), 1256u);
+}
+
+TEST(Arena, release)
+{
+    Arena arena(64);
+    for(int i = 0; i < 100; ++i)
+    {
+        arena.allocate(16);
+    }
+    std::size_t capacity = arena.capacity();
+    arena.release();
+    EXPECT_LT(arena.capacity(), capacity);
+
+    std::size_t kept = arena.capacity();
+    arena.allocate(16);
+    EXPECT_EQ(arena.capacity(), kept);
+}
+
+namespace {
+
+struct Node
+{
+    static int s_alive;
+    char d_pad[YAPEG_ANY_INLINE_SIZE];
+    std::vector<std::string> d_children;
+    
+    Node() { ++s_alive; }
+    Node(const Node& other): d_children(other.d_children) { ++s_alive; }
+    ~Node() { --s_alive; }
+};
+int Node::s_alive = 0;
+    
+} // close anonymous namespace
+    
+TEST(Arena, any)
+{
+    Arena arena(1024);
+    {
+        Any a(&arena);
+        EXPECT_EQ(a.arena(), &arena);
+        
+        Node node;
+        node.d_children.push_back("leaf");
+        a.set(node);
+        EXPECT_EQ(Node::s_alive, 2);
+        std::size_t capacity = arena.capacity();
+        EXPECT_GT(capacity, 0u);
+
+        Any b(a);
+        EXPECT_EQ(b.arena(), nullptr);
+        EXPECT_EQ(arena.capacity(), capacity);
+        EXPECT_EQ(b.get<Node>().d_children[0], "leaf");
+
+        Any c(std::move(a));
+        EXPECT_EQ(c.arena(), &arena);
+        EXPECT_EQ(c.get<Node>().d_children[0], "leaf");
+
+        b = c;
+        Any d(&arena);
+        d = b;
+        d = std::move(b);
+        EXPECT_EQ(d.get<Node>().d_children[0], "leaf");
+        
+        c.set<int>(3);
+        EXPECT_EQ(Node::s_alive, 2);
+    }
+    EXPECT_EQ(Node::s_alive, 0);
+    arena.release();
+}
+
+namespace {
+
+class State
+{
+private:
+    // DATA
+    std::size_t d_pos;
+    Arena d_arena;
+    Any d_cache;
+
+public:
+    // CREATORS
+    State()
+        : d_pos(0)
+        , d_cache(&d_arena) {}
+
+    // MANIPULATORS
+    void setPos(std::size_t pos) { d_pos = pos; }
+
+    Any& cache() { return d_cache; }
+
+    void reset()
+    {
+        d_pos = 0;
+        d_cache.clear();
+        d_arena.release();
+    }
+    
+    // ACCESSORS
+    std::size_t getPos() const { return d_pos; }
+
+    const Arena& arena() const { return d_arena; }
+};
+
+} // close anonymous namespace
+
+TEST(Arena, invoke)
+{
+    using Cbnt = Combinators<State>;
+    
+    State state;
+    Node node;
+    Node result;
+    Cbnt::Parser p =
+        Cbnt::combo(
+            [&node](State& s, bool must)->Cbnt::RCode
+            {
+                return Cbnt::invoke(
+                    [](State&, bool) { return Cbnt::RCode::SUCCESS; },
+                    s, must, node);
+            },
+            Cbnt::capture<Node>(result));
+
+    node.d_children.push_back("x");
+    EXPECT_EQ(p(state, true), Cbnt::RCode::SUCCESS);
+    EXPECT_GT(state.arena().capacity(), 0u);
+    EXPECT_EQ(result.d_children[0], "x");
+
+    state.reset();
+    EXPECT_EQ(Node::s_alive, 2);
+}
+    
+} // close namespace yapeg
@@ -0,0 +1,140 @@
+#include <yapeg_bench.h>
+#include <yapeg_ast.h>
+#include <yapeg_scanners.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using Scn = Scanners<BufferState>;
+
+enum Kind { LIST, ATOM };
+
+// Tree of individually allocated nodes, for comparison.
+struct HeapNode
+{
+    int d_kind;
+    std::size_t d_begin;
+    std::size_t d_end;
+    std::vector<std::unique_ptr<HeapNode> > d_children;
+};
+
+std::vector<std::unique_ptr<HeapNode> > s_open;
+
+Cbnt::Parser heapNode(int kind, Cbnt::Parser parser)
+{
+    return
+        [kind, parser](BufferState& state, bool must)->Cbnt::RCode
+        {
+            std::unique_ptr<HeapNode> node(new HeapNode());
+            node->d_kind = kind;
+            node->d_begin = state.getPos();
+            s_open.push_back(std::move(node));
+            Cbnt::RCode rc = parser(state, must);
+            node = std::move(s_open.back());
+            s_open.pop_back();
+            if(Cbnt::RCode::FAIL != rc)
+            {
+                node->d_end = state.getPos();
+                s_open.back()->d_children.push_back(std::move(node));
+            }
+            return rc;
+        };
+}
+
+// list <- '(' item (' ' item)* ')', item <- atom / list
+Cbnt::Parser listGrammar(bool flat, Cbnt::Rule& list)
+{
+    auto node = flat ? &Cbnt::node : &heapNode;
+    Cbnt::Parser item =
+        Cbnt::choice({
+            node(ATOM, Scn::plus(Scn::range('a', 'z'))),
+            list
+        });
+    list.define(
+        node(LIST,
+             Cbnt::seq({
+                 Scn::ch('('), item,
+                 Scn::star(Cbnt::seq({ Scn::ch(' '), item })),
+                 Scn::ch(')')
+             })));
+    return list;
+}
+
+std::string listInput()
+{
+    std::string text = "(";
+    for(int i = 0; i < 4000; ++i)
+    {
+        if(i) text += " ";
+        text += "(abc (de f) (g (h ij)))";
+    }
+    return text + ")";
+}
+
+std::size_t countHeap(const HeapNode& node)
+{
+    std::size_t count = 1;
+    for(auto it = node.d_children.begin(); it != node.d_children.end(); ++it)
+    {
+        count += countHeap(**it);
+    }
+    return count;
+}
+
+std::size_t countFlat(const Ast& ast, std::size_t index)
+{
+    std::size_t count = 0;
+    for(; index != Ast::k_NONE; index = ast[index].d_nextSibling)
+    {
+        count += 1 + countFlat(ast, ast[index].d_firstChild);
+    }
+    return count;
+}
+
+void benchFlat(bench::Counters& counters)
+{
+    static const std::string input = listInput();
+    static Cbnt::Rule list;
+    static const Cbnt::Parser grammar = listGrammar(true, list);
+
+    Ast ast;
+    BufferState state(input);
+    state.buildAst(&ast);
+    grammar(state, false);
+    assert(state.getPos() == input.size());
+    std::size_t count = countFlat(ast, 0);
+    bench::keep(count);
+    counters.d_bytes += input.size();
+    counters.d_items += count;
+}
+bench::Registrar s_flat("ast/flat", &benchFlat);
+
+void benchHeap(bench::Counters& counters)
+{
+    static const std::string input = listInput();
+    static Cbnt::Rule list;
+    static const Cbnt::Parser grammar = listGrammar(false, list);
+
+    s_open.emplace_back(new HeapNode());
+    BufferState state(input);
+    grammar(state, false);
+    assert(state.getPos() == input.size());
+    std::size_t count = countHeap(*s_open.back()) - 1;
+    s_open.clear();
+    bench::keep(count);
+    counters.d_bytes += input.size();
+    counters.d_items += count;
+}
+bench::Registrar s_heap("ast/heap", &benchHeap);
+
+} // close anonymous namespace
+
+} // close namespace yapeg
@@ -0,0 +1,117 @@
+#include <yapeg_ast.h>
+#include <cassert>
+
+namespace yapeg {
+
+const std::size_t Ast::k_NONE;
+
+// MANIPULATORS
+void Ast::truncate(std::size_t size)
+{
+    assert(d_open.empty() || d_open.back() < size);
+    d_nodes.erase(d_nodes.begin() + size, d_nodes.end());
+    // only the nodes on the path to the new last node can link past it
+    for(std::size_t x = size ? size - 1 : k_NONE; x != k_NONE; )
+    {
+        Node& node = d_nodes[x];
+        if(node.d_firstChild != k_NONE && node.d_firstChild >= size)
+        {
+            node.d_firstChild = k_NONE;
+        }
+        if(node.d_nextSibling != k_NONE && node.d_nextSibling >= size)
+        {
+            node.d_nextSibling = k_NONE;
+        }
+        x = node.d_parent;
+    }
+}
+
+void Ast::link(std::size_t index)
+{
+    std::size_t parent = d_open.empty() ? k_NONE : d_open.back();
+
+    // the previous sibling, if any, is on the path to the last node
+    std::size_t prev = index ? index - 1 : k_NONE;
+    while(prev != parent && d_nodes[prev].d_parent != parent)
+    {
+        prev = d_nodes[prev].d_parent;
+    }
+    if(prev != parent)
+    {
+        d_nodes[prev].d_nextSibling = index;
+    }
+    else if(parent != k_NONE)
+    {
+        d_nodes[parent].d_firstChild = index;
+    }
+}
+
+std::size_t Ast::open(int kind, std::size_t pos)
+{
+    std::size_t index = d_nodes.size();
+    std::size_t parent = d_open.empty() ? k_NONE : d_open.back();
+    link(index);
+    Node node = { kind, pos, k_NONE, parent, k_NONE, k_NONE };
+    d_nodes.push_back(node);
+    d_open.push_back(index);
+    return index;
+}
+
+void Ast::close(std::size_t node, std::size_t pos)
+{
+    assert(!d_open.empty() && d_open.back() == node);
+    d_nodes[node].d_end = pos;
+    d_open.pop_back();
+}
+
+void Ast::abandon(std::size_t node)
+{
+    assert(!d_open.empty() && d_open.back() == node);
+    d_open.pop_back();
+    truncate(node);
+}
+
+void Ast::replay(const std::vector<Node>& subtrees)
+{
+    if(subtrees.empty())
+    {
+        return;
+    }
+    std::size_t base = d_nodes.size();
+    std::size_t parent = d_open.empty() ? k_NONE : d_open.back();
+    link(base);
+    for(auto it = subtrees.begin(); it != subtrees.end(); ++it)
+    {
+        Node node = *it;
+        assert(node.d_end != k_NONE);
+        node.d_parent = k_NONE == node.d_parent ? parent
+                                                : node.d_parent + base;
+        if(node.d_firstChild != k_NONE) node.d_firstChild += base;
+        if(node.d_nextSibling != k_NONE) node.d_nextSibling += base;
+        d_nodes.push_back(node);
+    }
+}
+
+void Ast::clear()
+{
+    d_nodes.clear();
+    d_open.clear();
+}
+
+// ACCESSORS
+std::vector<Ast::Node> Ast::subtrees(std::size_t from) const
+{
+    assert(d_open.empty() || d_open.back() < from);
+    std::vector<Node> nodes(d_nodes.begin() + from, d_nodes.end());
+    for(auto it = nodes.begin(); it != nodes.end(); ++it)
+    {
+        Node& node = *it;
+        node.d_parent = k_NONE == node.d_parent || node.d_parent < from
+                      ? k_NONE : node.d_parent - from;
+        if(node.d_firstChild != k_NONE) node.d_firstChild -= from;
+        if(node.d_nextSibling != k_NONE) node.d_nextSibling -= from;
+    }
+    return nodes;
+}
+
+} // close namespace yapeg
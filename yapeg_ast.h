@@ -0,0 +1,102 @@
+#ifndef INCLUDED_YAPEG_AST_H
+#define INCLUDED_YAPEG_AST_H
+
+#include <cstddef>
+#include <vector>
+
+namespace yapeg {
+
+// Syntax tree built by Combinators::node into one vector, in preorder:
+// a node is followed by its descendants, and its children are linked
+// from its first child through their next siblings.  A node is open
+// while its parser runs, and new nodes become children of the last open
+// node.  A frame that backtracks rewinds the tree to the size it had
+// when the frame started (see Combinators::SavedPos), so all the nodes
+// of a failed alternative disappear.  Positions are input offsets.
+class Ast
+{
+public:
+    // TYPES
+    struct Node
+    {
+        int d_kind;
+        std::size_t d_begin;        // span of the node's input
+        std::size_t d_end;          // k_NONE while open
+        std::size_t d_parent;       // k_NONE for a top-level node
+        std::size_t d_firstChild;   // k_NONE for a leaf
+        std::size_t d_nextSibling;  // k_NONE for the last child
+    };
+
+    static const std::size_t k_NONE = static_cast<std::size_t>(-1);
+
+private:
+    // DATA
+    std::vector<Node> d_nodes;
+    std::vector<std::size_t> d_open;  // open nodes, innermost last
+
+    // MANIPULATORS
+    void truncate(std::size_t size);
+
+    // Link the new node at 'index' as the last child of the innermost
+    // open node, or as the last top-level node.
+    void link(std::size_t index);
+
+public:
+    // MANIPULATORS
+
+    // Append an open node of 'kind' starting at 'pos' and return its
+    // index.
+    std::size_t open(int kind, std::size_t pos);
+
+    // Close the innermost open node 'node' at 'pos'.
+    void close(std::size_t node, std::size_t pos);
+
+    // Drop the innermost open node 'node' and its descendants.
+    void abandon(std::size_t node);
+
+    // Drop the nodes from index 'size' on, which must be closed, as a
+    // frame that started when the Ast had 'size' nodes backtracks.
+    void rewind(std::size_t size)
+    {
+        if(size < d_nodes.size())
+        {
+            truncate(size);
+        }
+    }
+
+    // Append copies of the closed 'subtrees' recorded by subtrees() as
+    // the last children of the innermost open node, as memo does when
+    // it reuses a result.
+    void replay(const std::vector<Node>& subtrees);
+
+    void clear();
+
+    // ACCESSORS
+    const std::vector<Node>& nodes() const
+    {
+        return d_nodes;
+    }
+
+    // Return the closed nodes from index 'from' on, with their links
+    // relative to 'from' and k_NONE as the parent of the top-level ones.
+    std::vector<Node> subtrees(std::size_t from) const;
+
+    const Node& operator[] (std::size_t index) const
+    {
+        return d_nodes[index];
+    }
+
+    std::size_t size() const
+    {
+        return d_nodes.size();
+    }
+
+    bool empty() const
+    {
+        return d_nodes.empty();
+    }
+};
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_AST_H
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <yapeg_ast.h>
+#include <yapeg_scanners.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using Scn = Scanners<BufferState>;
+
+enum Kind { LIST, ATOM, ASSIGN, CALL };
+
+// Return the subtrees from 'index' on as "kind[begin,end](children)".
+std::string dump(const Ast& ast, std::size_t index)
+{
+    std::string text;
+    for(; index != Ast::k_NONE; index = ast[index].d_nextSibling)
+    {
+        const Ast::Node& node = ast[index];
+        if(!text.empty()) text += " ";
+        text += std::to_string(node.d_kind) + "[" +
+            std::to_string(node.d_begin) + "," +
+            (Ast::k_NONE == node.d_end ? std::string("?")
+                                       : std::to_string(node.d_end)) + "]";
+        if(node.d_firstChild != Ast::k_NONE)
+        {
+            EXPECT_EQ(ast[node.d_firstChild].d_parent, index);
+            text += "(" + dump(ast, node.d_firstChild) + ")";
+        }
+    }
+    return text;
+}
+
+std::string dump(const Ast& ast)
+{
+    return ast.empty() ? "" : dump(ast, 0);
+}
+
+} // close anonymous namespace
+
+TEST(Ast, build)
+{
+    Ast ast;
+    std::size_t a = ast.open(LIST, 0);
+    ast.close(ast.open(ATOM, 1), 2);
+    std::size_t b = ast.open(LIST, 3);
+    ast.close(ast.open(ATOM, 4), 5);
+    ast.close(b, 6);
+    ast.close(a, 7);
+    ast.close(ast.open(ATOM, 8), 9);
+    EXPECT_EQ(dump(ast), "0[0,7](1[1,2] 0[3,6](1[4,5])) 1[8,9]");
+
+    // the second list is dropped with its atom
+    ast.rewind(2);
+    EXPECT_EQ(dump(ast), "0[0,7](1[1,2])");
+    ast.rewind(1);
+    EXPECT_EQ(dump(ast), "0[0,7]");
+
+    // nodes matching nothing go too
+    std::size_t c = ast.open(LIST, 7);
+    ast.close(ast.open(ATOM, 7), 7);
+    ast.rewind(2);
+    EXPECT_EQ(dump(ast), "0[0,7] 0[7,?]");
+    ast.close(ast.open(ATOM, 7), 8);
+    ast.close(ast.open(ATOM, 8), 8);
+    ast.rewind(3);
+    EXPECT_EQ(dump(ast), "0[0,7] 0[7,?](1[7,8])");
+
+    // replayed subtrees become children of the innermost open node
+    std::size_t d = ast.open(LIST, 8);
+    ast.close(ast.open(ATOM, 8), 9);
+    ast.close(d, 9);
+    std::vector<Ast::Node> subtrees = ast.subtrees(2);
+    ast.rewind(2);
+    ast.replay(subtrees);
+    ast.replay(subtrees);
+    EXPECT_EQ(dump(ast),
+              "0[0,7] 0[7,?](1[7,8] 0[8,9](1[8,9]) 1[7,8] 0[8,9](1[8,9]))");
+    ast.abandon(c);
+    EXPECT_EQ(dump(ast), "0[0,7]");
+
+    ast.clear();
+    EXPECT_TRUE(ast.empty());
+}
+
+TEST(Ast, node)
+{
+    // list <- '(' ' '* (atom / list) (' '+ (atom / list))* ')'
+    Cbnt::Rule list;
+    Cbnt::Parser atom = Cbnt::node(ATOM, Scn::plus(Scn::range('a', 'z')));
+    Cbnt::Parser item = Cbnt::choice({ atom, list });
+    list.define(
+        Cbnt::node(LIST,
+                   Cbnt::seq({
+                       Scn::ch('('), Scn::star(Scn::ch(' ')), item,
+                       Scn::star(Cbnt::seq({ Scn::plus(Scn::ch(' ')), item })),
+                       Scn::ch(')')
+                   })));
+
+    std::string text("(a (b cd) e)");
+    Ast ast;
+    BufferState state(text);
+    state.buildAst(&ast);
+    EXPECT_EQ(list(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(dump(ast),
+              "0[0,12](1[1,2] 0[3,9](1[4,5] 1[6,8]) 1[10,11])");
+
+    // a failed list leaves nothing
+    ast.clear();
+    std::string open("(a (b c)");
+    state.reset(open);
+    EXPECT_EQ(list(state, false), Cbnt::RCode::FAIL);
+    EXPECT_TRUE(ast.empty());
+
+    // nor does a failure thrown out of it
+    state.reset(open);
+    EXPECT_THROW(list(state, true), ScanError);
+    EXPECT_TRUE(ast.empty());
+    list.reset();
+
+    // without an Ast the nodes are plain parsers
+    state.buildAst(nullptr);
+    state.reset(text);
+    EXPECT_EQ(atom(state, false), Cbnt::RCode::FAIL);
+}
+
+TEST(Ast, nodeBacktrack)
+{
+    // stmt <- atom '=' atom / atom '(' ')'
+    Cbnt::Parser atom = Cbnt::node(ATOM, Scn::plus(Scn::range('a', 'z')));
+    Cbnt::Parser stmt =
+        Cbnt::choice({
+            Cbnt::node(ASSIGN, Cbnt::seq({ atom, Scn::ch('='), atom })),
+            Cbnt::node(CALL, Cbnt::seq({ atom, Scn::literal("()") }))
+        });
+
+    Ast ast;
+    std::string text("f()");
+    BufferState state(text);
+    state.buildAst(&ast);
+    EXPECT_EQ(stmt(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(dump(ast), "3[0,3](1[0,1])");
+
+    // nodes inside a lookahead are dropped when it rewinds
+    ast.clear();
+    state.setPos(0);
+    EXPECT_EQ(Cbnt::seq({ Cbnt::ptest(stmt), atom })(state, false),
+              Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(dump(ast), "1[0,1]");
+}
+
+TEST(Ast, nodeBacktrackEmpty)
+{
+    // a failed alternative drops its nodes, even those matching nothing
+    Cbnt::Parser stmt =
+        Cbnt::choice({
+            Cbnt::seq({ Cbnt::node(LIST, Cbnt::qmark(Scn::ch('x'))),
+                        Scn::ch('y') }),
+            Cbnt::node(ATOM, Scn::ch('z'))
+        });
+
+    Ast ast;
+    std::string text("z");
+    BufferState state(text);
+    state.buildAst(&ast);
+    EXPECT_EQ(stmt(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(dump(ast), "1[0,1]");
+}
+
+TEST(Ast, nodeMemo)
+{
+    // a memo hit replays the nodes of the recorded match
+    Cbnt::Parser atom =
+        Cbnt::memo(Cbnt::node(ATOM, Scn::plus(Scn::range('a', 'z'))));
+    Cbnt::Parser stmt =
+        Cbnt::choice({
+            Cbnt::node(ASSIGN, Cbnt::seq({ atom, Scn::ch('='), atom })),
+            Cbnt::node(CALL, Cbnt::seq({ atom, Scn::literal("()") }))
+        });
+
+    Ast ast;
+    std::string text("f()");
+    BufferState state(text);
+    state.buildAst(&ast);
+    EXPECT_EQ(stmt(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(dump(ast), "3[0,3](1[0,1])");
+
+    // a grown left-recursive rule keeps the nodes of its longest match
+    // expr <- node(expr '-' atom) / atom
+    Cbnt::Rule expr;
+    expr.define(
+        Cbnt::memo(
+            Cbnt::choice({
+                Cbnt::node(LIST,
+                           Cbnt::seq({ expr, Scn::ch('-'), atom })),
+                atom
+            })));
+    ast.clear();
+    std::string diff("a-b-c");
+    state.reset(diff);
+    EXPECT_EQ(expr(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), diff.size());
+    EXPECT_EQ(dump(ast), "0[0,5](0[0,3](1[0,1] 1[2,3]) 1[4,5])");
+    expr.reset();
+}
+
+} // close namespace yapeg
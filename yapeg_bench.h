@@ -0,0 +1,49 @@
+#ifndef INCLUDED_YAPEG_BENCH_H
+#define INCLUDED_YAPEG_BENCH_H
+
+// Minimal benchmark harness for the '*.b.cpp' sources built by
+// 'make bench'.  Each benchmark runs one iteration per call and reports
+// the work done through Counters; results are printed one JSON object
+// per line.
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace yapeg {
+namespace bench {
+
+struct Counters
+{
+    std::size_t d_bytes;  // input bytes consumed
+    std::size_t d_items;  // tokens, values or operations processed
+    std::size_t d_calls;  // combinator calls, 0 if not measured
+};
+    
+using Func = std::function<void (Counters&)>;
+
+// Register 'func' to run under 'name'.
+void add(const std::string& name, const Func& func);
+
+// Number of global operator new calls so far.
+std::size_t allocations();
+
+// Prevent the optimizer from discarding 'value'.
+template<typename T>
+void keep(const T& value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+    
+struct Registrar
+{
+    Registrar(const std::string& name, const Func& func)
+    {
+        add(name, func);
+    }
+};
+    
+} // close namespace bench
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_BENCH_H
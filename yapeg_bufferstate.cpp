@@ -0,0 +1,45 @@
+#include <yapeg_bufferstate.h>
+
+namespace yapeg {
+
+// CREATORS
+BufferState::BufferState(const char* begin, const char* end)
+    : d_begin(begin)
+    , d_end(end)
+    , d_pos(0)
+    , d_failures(nullptr)
+    , d_ast(nullptr)
+{
+    assert(begin <= end);
+}
+
+BufferState::BufferState(const std::string& text)
+    : d_begin(text.data())
+    , d_end(text.data() + text.size())
+    , d_pos(0)
+    , d_failures(nullptr)
+    , d_ast(nullptr)
+{
+}
+
+// MANIPULATORS
+void BufferState::reset(const char* begin, const char* end)
+{
+    assert(begin <= end);
+    d_begin = begin;
+    d_end = end;
+    d_pos = 0;
+    d_cache.clear();
+    d_memo.clear();
+    if(d_ast)
+    {
+        d_ast->clear();
+    }
+}
+
+void BufferState::reset(const std::string& text)
+{
+    reset(text.data(), text.data() + text.size());
+}
+    
+} // close namespace yapeg
@@ -0,0 +1,107 @@
+#ifndef INCLUDED_YAPEG_BUFFERSTATE_H
+#define INCLUDED_YAPEG_BUFFERSTATE_H
+
+#include <yapeg_any.h>
+#include <yapeg_ast.h>
+#include <yapeg_failure.h>
+#include <yapeg_memo.h>
+#include <cassert>
+#include <cstddef>
+#include <string>
+
+namespace yapeg {
+
+// State over a contiguous byte range that is not owned.  Positions are
+// byte offsets from the beginning of the range.  Provides the character
+// level interface used by Scanners.
+class BufferState
+{
+private:
+    // DATA
+    const char* d_begin;
+    const char* d_end;
+    std::size_t d_pos;
+    Any d_cache;
+    MemoTable<std::size_t> d_memo;
+    FarthestFailure* d_failures;  // not owned, null to throw
+    Ast* d_ast;                   // not owned, null to build no tree
+    
+public:
+    // CREATORS
+    BufferState(const char* begin, const char* end);
+    explicit BufferState(const std::string& text);
+    explicit BufferState(std::string&&) = delete;
+    BufferState(const BufferState&) = delete;
+    BufferState& operator= (const BufferState&) = delete;
+    
+    // MANIPULATORS
+    void setPos(std::size_t pos)
+    {
+        assert(pos <= size());
+        d_pos = pos;
+    }
+
+    void advance(std::size_t n)
+    {
+        assert(n <= fetch(n));
+        d_pos += n;
+    }
+    
+    Any& cache() { return d_cache; }
+
+    MemoTable<std::size_t>& memoTable() { return d_memo; }
+
+    void trackFailures(FarthestFailure* failures)
+    {
+        d_failures = failures;
+    }
+
+    // Build the nodes of Combinators::node into 'ast', or none if null.
+    void buildAst(Ast* ast)
+    {
+        d_ast = ast;
+    }
+
+    // Start over on the specified input, clearing cache, memo table and
+    // Ast.
+    void reset(const char* begin, const char* end);
+    void reset(const std::string& text);
+    void reset(std::string&&) = delete;
+    
+    // ACCESSORS
+    std::size_t getPos() const
+    {
+        return d_pos;
+    }
+
+    // Return the number of bytes available at current(), which is at
+    // least 'n' unless the input ends first.
+    std::size_t fetch(std::size_t) const
+    {
+        return size() - d_pos;
+    }
+    
+    const char* current() const
+    {
+        return d_begin + d_pos;
+    }
+
+    const Any& cache() const { return d_cache; }
+
+    FarthestFailure* failures() const { return d_failures; }
+
+    Ast* ast() const { return d_ast; }
+
+    const char* begin() const { return d_begin; }
+
+    const char* end() const { return d_end; }
+
+    std::size_t size() const
+    {
+        return static_cast<std::size_t>(d_end - d_begin);
+    }
+};
+    
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_BUFFERSTATE_H
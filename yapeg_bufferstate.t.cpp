@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <yapeg_bufferstate.h>
+#include <string>
+
+namespace yapeg {
+
+TEST(BufferState, positions)
+{
+    std::string text("hello");
+    BufferState state(text);
+    EXPECT_EQ(state.getPos(), 0u);
+    EXPECT_EQ(state.size(), 5u);
+    EXPECT_EQ(state.fetch(1), 5u);
+    EXPECT_EQ(*state.current(), 'h');
+
+    state.advance(2);
+    EXPECT_EQ(state.getPos(), 2u);
+    EXPECT_EQ(*state.current(), 'l');
+    EXPECT_EQ(state.fetch(10), 3u);
+
+    state.setPos(5);
+    EXPECT_EQ(state.fetch(1), 0u);
+    state.setPos(1);
+    EXPECT_EQ(*state.current(), 'e');
+}
+
+TEST(BufferState, reset)
+{
+    std::string text1("abc");
+    std::string text2("xy");
+    
+    BufferState state(text1.data(), text1.data() + text1.size());
+    state.advance(2);
+    state.cache().set(3);
+    state.memoTable().insert(0, 0);
+
+    state.reset(text2);
+    EXPECT_EQ(state.getPos(), 0u);
+    EXPECT_EQ(state.size(), 2u);
+    EXPECT_TRUE(state.cache().isNone());
+    EXPECT_EQ(state.memoTable().size(), 0u);
+    EXPECT_EQ(*state.current(), 'x');
+}
+    
+} // close namespace yapeg
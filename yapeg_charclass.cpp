@@ -0,0 +1,225 @@
+#include <yapeg_charclass.h>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace yapeg {
+
+namespace {
+
+std::size_t spanScalar(const CharClass& cls, const char* begin, const char* end)
+{
+    const char* p = begin;
+    while(p != end && cls.test(*p)) ++p;
+    return static_cast<std::size_t>(p - begin);
+}
+
+unsigned countTrailingZeros(unsigned mask)
+{
+    return static_cast<unsigned>(__builtin_ctz(mask));
+}
+    
+} // close anonymous namespace
+    
+// CREATORS
+CharClass::CharClass()
+    : d_numRanges(0)
+{
+    // an empty class, as update() would leave it
+    std::memset(d_bits, 0, sizeof(d_bits));
+    std::memset(d_lowRows, 0, sizeof(d_lowRows));
+    std::memset(d_highRows, 0, sizeof(d_highRows));
+}
+
+CharClass::CharClass(const std::string& chars)
+    : CharClass()
+{
+    for(auto it = chars.begin(); it != chars.end(); ++it)
+    {
+        add(*it);
+    }
+}
+
+CharClass::CharClass(char lo, char hi)
+    : CharClass()
+{
+    add(lo, hi);
+}
+
+// MANIPULATORS
+void CharClass::update()
+{
+    for(int lo = 0; lo < 16; ++lo)
+    {
+        d_lowRows[lo] = 0;
+        d_highRows[lo] = 0;
+        for(int hi = 0; hi < 8; ++hi)
+        {
+            if(test(static_cast<char>(hi << 4 | lo)))
+            {
+                d_lowRows[lo] |= 1 << hi;
+            }
+            if(test(static_cast<char>((hi + 8) << 4 | lo)))
+            {
+                d_highRows[lo] |= 1 << hi;
+            }
+        }
+    }
+    
+    d_numRanges = 0;
+    for(int c = 0; c < 256; )
+    {
+        if(!test(static_cast<char>(c)))
+        {
+            ++c;
+            continue;
+        }
+        int lo = c;
+        while(c < 256 && test(static_cast<char>(c))) ++c;
+        if(d_numRanges == k_MAX_RANGES)
+        {
+            d_numRanges = -1;
+            return;
+        }
+        d_rangeLo[d_numRanges] = static_cast<unsigned char>(lo);
+        d_rangeHi[d_numRanges] = static_cast<unsigned char>(c - 1);
+        ++d_numRanges;
+    }
+}
+
+CharClass& CharClass::add(char c)
+{
+    return add(c, c);
+}
+
+CharClass& CharClass::add(char lo, char hi)
+{
+    unsigned ulo = static_cast<unsigned char>(lo);
+    unsigned uhi = static_cast<unsigned char>(hi);
+    for(unsigned u = ulo; u <= uhi; ++u)
+    {
+        d_bits[u >> 6] |= std::uint64_t(1) << (u & 63);
+    }
+    update();
+    return *this;
+}
+
+CharClass& CharClass::add(const CharClass& other)
+{
+    for(int i = 0; i < 4; ++i)
+    {
+        d_bits[i] |= other.d_bits[i];
+    }
+    update();
+    return *this;
+}
+    
+CharClass& CharClass::negate()
+{
+    for(int i = 0; i < 4; ++i)
+    {
+        d_bits[i] = ~d_bits[i];
+    }
+    update();
+    return *this;
+}
+    
+// ACCESSORS
+std::size_t CharClass::span(const char* begin, const char* end) const
+{
+    const char* p = begin;
+#if defined(__AVX2__)
+    // Split each byte into nibbles: the low nibble selects a row of the
+    // bitmap through two 16-entry tables (high nibble 0-7 and 8-15), the
+    // high nibble selects the bit within that row.
+    const __m256i lowTable = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(d_lowRows)));
+    const __m256i highTable = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(d_highRows)));
+    const __m256i bitTable = _mm256_setr_epi8(
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+    while(end - p >= 32)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i lo = _mm256_and_si256(x, nibble);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+        __m256i row = _mm256_blendv_epi8(
+            _mm256_shuffle_epi8(lowTable, lo),
+            _mm256_shuffle_epi8(highTable, lo),
+            x);
+        __m256i bit = _mm256_shuffle_epi8(bitTable, hi);
+        __m256i miss = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), zero);
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(miss));
+        if(mask)
+        {
+            return static_cast<std::size_t>(p - begin) +
+                countTrailingZeros(mask);
+        }
+        p += 32;
+    }
+#elif defined(__SSE2__)
+    if(d_numRanges >= 0)
+    {
+        // 'c' is in [lo, hi] iff (c - lo) <= (hi - lo) as unsigned bytes
+        __m128i los[k_MAX_RANGES];
+        __m128i widths[k_MAX_RANGES];
+        for(int i = 0; i < d_numRanges; ++i)
+        {
+            los[i] = _mm_set1_epi8(static_cast<char>(d_rangeLo[i]));
+            widths[i] = _mm_set1_epi8(
+                static_cast<char>(d_rangeHi[i] - d_rangeLo[i]));
+        }
+        while(end - p >= 16)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hit = _mm_setzero_si128();
+            for(int i = 0; i < d_numRanges; ++i)
+            {
+                __m128i d = _mm_sub_epi8(x, los[i]);
+                hit = _mm_or_si128(
+                    hit, _mm_cmpeq_epi8(_mm_min_epu8(d, widths[i]), d));
+            }
+            unsigned mask =
+                ~static_cast<unsigned>(_mm_movemask_epi8(hit)) & 0xffff;
+            if(mask)
+            {
+                return static_cast<std::size_t>(p - begin) +
+                    countTrailingZeros(mask);
+            }
+            p += 16;
+        }
+    }
+#endif
+    return static_cast<std::size_t>(p - begin) + spanScalar(*this, p, end);
+}
+
+std::string CharClass::describe() const
+{
+    std::string result = "[";
+    for(int c = 0; c < 256; )
+    {
+        if(!test(static_cast<char>(c)))
+        {
+            ++c;
+            continue;
+        }
+        int lo = c;
+        while(c < 256 && test(static_cast<char>(c))) ++c;
+        result += static_cast<char>(lo);
+        if(c - 1 > lo)
+        {
+            if(c - 1 > lo + 1) result += '-';
+            result += static_cast<char>(c - 1);
+        }
+    }
+    return result + "]";
+}
+    
+} // close namespace yapeg
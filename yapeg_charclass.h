@@ -0,0 +1,61 @@
+#ifndef INCLUDED_YAPEG_CHARCLASS_H
+#define INCLUDED_YAPEG_CHARCLASS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace yapeg {
+
+// A set of byte values kept as a 256-bit bitmap, with a vectorized scan
+// for the longest prefix of a buffer inside the set.  The scan uses AVX2
+// when compiled for it, SSE2 range compares when the set is made of at
+// most k_MAX_RANGES ranges, and a scalar loop otherwise.
+class CharClass
+{
+public:
+    // CONSTANTS
+    enum { k_MAX_RANGES = 8 };
+    
+private:
+    // DATA
+    std::uint64_t d_bits[4];
+    alignas(16) unsigned char d_lowRows[16];   // see span
+    alignas(16) unsigned char d_highRows[16];
+    unsigned char d_rangeLo[k_MAX_RANGES];
+    unsigned char d_rangeHi[k_MAX_RANGES];
+    int d_numRanges;  // -1 if more than k_MAX_RANGES
+
+private:
+    // MANIPULATORS
+    void update();
+    
+public:
+    // CREATORS
+    CharClass();
+    explicit CharClass(const std::string& chars);
+    CharClass(char lo, char hi);
+
+    // MANIPULATORS
+    CharClass& add(char c);
+    CharClass& add(char lo, char hi);
+    CharClass& add(const CharClass& other);
+    CharClass& negate();
+    
+    // ACCESSORS
+    bool test(char c) const
+    {
+        unsigned char u = static_cast<unsigned char>(c);
+        return (d_bits[u >> 6] >> (u & 63)) & 1;
+    }
+
+    // Return the number of leading bytes of [begin, end) in the set.
+    std::size_t span(const char* begin, const char* end) const;
+
+    // Return a bracket expression such as "[0-9_a-z]".
+    std::string describe() const;
+};
+    
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_CHARCLASS_H
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <yapeg_charclass.h>
+#include <cstring>
+#include <new>
+#include <string>
+
+namespace yapeg {
+
+TEST(CharClass, test)
+{
+    CharClass ws(" \t\r\n");
+    EXPECT_TRUE(ws.test(' '));
+    EXPECT_TRUE(ws.test('\n'));
+    EXPECT_FALSE(ws.test('a'));
+    EXPECT_FALSE(ws.test('\0'));
+
+    CharClass ident('a', 'z');
+    ident.add('A', 'Z').add('0', '9').add('_');
+    EXPECT_TRUE(ident.test('q'));
+    EXPECT_TRUE(ident.test('_'));
+    EXPECT_FALSE(ident.test('-'));
+    EXPECT_EQ(ident.describe(), "[0-9A-Z_a-z]");
+
+    CharClass high(static_cast<char>(0x80), static_cast<char>(0xff));
+    EXPECT_TRUE(high.test(static_cast<char>(0xe9)));
+    EXPECT_FALSE(high.test('e'));
+    high.negate();
+    EXPECT_TRUE(high.test('e'));
+    EXPECT_FALSE(high.test(static_cast<char>(0xe9)));
+}
+
+TEST(CharClass, span)
+{
+    CharClass ws(" \t\r\n");
+    std::string text(100, ' ');
+    for(std::size_t stop = 0; stop <= text.size(); ++stop)
+    {
+        std::string t = text;
+        if(stop < t.size()) t[stop] = 'x';
+        EXPECT_EQ(ws.span(t.data(), t.data() + t.size()), stop);
+        EXPECT_EQ(ws.span(t.data() + 1, t.data() + t.size()),
+                  stop ? stop - 1 : t.size() - 1);
+    }
+    EXPECT_EQ(ws.span(text.data(), text.data()), 0u);
+}
+
+TEST(CharClass, span_all_bytes)
+{
+    // more ranges than the SSE2 path handles, and non-ASCII bytes
+    CharClass odd;
+    for(int c = 1; c < 256; c += 2) odd.add(static_cast<char>(c));
+    
+    std::string text;
+    for(int i = 0; i < 300; ++i) text += static_cast<char>((i * 2 + 1) & 0xff);
+    for(std::size_t stop = 0; stop < text.size(); stop += 7)
+    {
+        std::string t = text;
+        t[stop] = static_cast<char>(0xf0);
+        EXPECT_EQ(odd.span(t.data(), t.data() + t.size()), stop);
+    }
+    EXPECT_EQ(odd.span(text.data(), text.data() + text.size()), text.size());
+
+    CharClass none;
+    EXPECT_EQ(none.span(text.data(), text.data() + text.size()), 0u);
+    none.negate();
+    EXPECT_EQ(none.span(text.data(), text.data() + text.size()), text.size());
+}
+
+TEST(CharClass, span_empty_over_garbage)
+{
+    // a default constructed class must not depend on prior memory
+    alignas(CharClass) unsigned char buffer[sizeof(CharClass)];
+    std::memset(buffer, 0xff, sizeof(buffer));
+    CharClass* empty = new (buffer) CharClass();
+    std::string text(100, 'a');
+    EXPECT_EQ(empty->span(text.data(), text.data() + text.size()), 0u);
+    empty->~CharClass();
+}
+    
+} // close namespace yapeg
@@ -0,0 +1,601 @@
+#include <yapeg_bench.h>
+#include <yapeg_combinators.h>
+#include <yapeg_any.h>
+#include <yapeg_memo.h>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace yapeg {
+
+namespace {
+
+// Character-level State; 'd_calls' counts position saves, one per
+// seq, normalize, action and lookahead frame.
+class TextState
+{
+private:
+    // DATA
+    const std::string& d_text;
+    std::size_t d_pos;
+    Any d_cache;
+    MemoTable<std::size_t> d_memo;
+    std::vector<long long> d_values;
+
+public:
+    // DATA
+    mutable std::size_t d_calls;
+    
+    // CREATORS
+    explicit TextState(const std::string& text)
+        : d_text(text)
+        , d_pos(0)
+        , d_calls(0) {}
+
+    // MANIPULATORS
+    void next() { ++d_pos; }
+
+    void setPos(std::size_t pos) { d_pos = pos; }
+
+    Any& cache() { return d_cache; }
+
+    MemoTable<std::size_t>& memoTable() { return d_memo; }
+
+    std::vector<long long>& values() { return d_values; }
+    
+    // ACCESSORS
+    bool isValid() const { return d_pos < d_text.size(); }
+
+    const std::string& text() const { return d_text; }
+
+    char peek() const { return d_text[d_pos]; }
+    
+    std::size_t getPos() const
+    {
+        ++d_calls;
+        return d_pos;
+    }
+};
+
+using Cbnt = Combinators<TextState>;
+using RCode = Cbnt::RCode;
+
+Cbnt::Parser ch(char c)
+{
+    return
+        [c](TextState& s, bool must)->RCode
+        {
+            if(s.isValid() && s.peek() == c)
+            {
+                s.next();
+                return RCode::SUCCESS;
+            }
+            return RCode::FAIL;
+        };
+}
+
+Cbnt::Parser range(char lo, char hi)
+{
+    return
+        [lo, hi](TextState& s, bool must)->RCode
+        {
+            if(s.isValid() && s.peek() >= lo && s.peek() <= hi)
+            {
+                s.next();
+                return RCode::SUCCESS;
+            }
+            return RCode::FAIL;
+        };
+}
+
+Cbnt::Parser lit(const std::string& str)
+{
+    std::vector<Cbnt::Parser> chars;
+    for(char c: str) chars.push_back(ch(c));
+    return Cbnt::seq(chars);
+}
+
+Cbnt::Parser recurse(const Cbnt::Parser& parser)
+{
+    return
+        [&parser](TextState& s, bool must)->RCode
+        {
+            return parser(s, must);
+        };
+}
+    
+// JSON
+struct JsonGrammar
+{
+    Cbnt::Parser d_value;
+    Cbnt::Parser d_ws;
+    std::size_t d_values;
+
+    JsonGrammar(): d_values(0)
+    {
+        Cbnt::Parser ws =
+            Cbnt::star(
+                Cbnt::choice({ ch(' '), ch('\n'), ch('\t'), ch('\r') }));
+        Cbnt::Parser digits = Cbnt::plus(range('0', '9'));
+        Cbnt::Parser number =
+            Cbnt::seq({
+                Cbnt::qmark(ch('-')),
+                digits,
+                Cbnt::qmark(Cbnt::seq({ ch('.'), digits }))
+            });
+        Cbnt::Parser string =
+            Cbnt::seq({
+                ch('"'),
+                Cbnt::star(
+                    Cbnt::choice({
+                        Cbnt::seq({ ch('\\'), range(' ', '~') }),
+                        Cbnt::seq({
+                            Cbnt::ntest(Cbnt::choice({ ch('"'), ch('\\') })),
+                            range(' ', '~')
+                        })
+                    })),
+                ch('"')
+            });
+        Cbnt::Parser value = recurse(d_value);
+        Cbnt::Parser member =
+            Cbnt::seq({ ws, string, ws, ch(':'), value });
+        Cbnt::Parser object =
+            Cbnt::seq({
+                ch('{'),
+                Cbnt::qmark(
+                    Cbnt::seq({
+                        member,
+                        Cbnt::star(Cbnt::seq({ ch(','), member }))
+                    })),
+                ws,
+                ch('}')
+            });
+        Cbnt::Parser array =
+            Cbnt::seq({
+                ch('['),
+                Cbnt::qmark(
+                    Cbnt::seq({
+                        value,
+                        Cbnt::star(Cbnt::seq({ ch(','), value }))
+                    })),
+                ws,
+                ch(']')
+            });
+        std::size_t& values = d_values;
+        d_value =
+            Cbnt::seq({
+                ws,
+                Cbnt::choice({
+                    object, array, string, number,
+                    lit("true"), lit("false"), lit("null")
+                }),
+                Cbnt::yaction([&values](TextState&) { ++values; }),
+                ws
+            });
+        d_ws = ws;
+    }
+};
+
+std::string jsonInput()
+{
+    std::string doc = "[";
+    for(int i = 0; i < 500; ++i)
+    {
+        if(i) doc += ",\n";
+        doc +=
+            "  {\"id\": " + std::to_string(i) +
+            ", \"name\": \"item \\\"" + std::to_string(i) + "\\\"\""
+            ", \"price\": -12.50, \"tags\": [\"a\", \"b\", null]"
+            ", \"ok\": true, \"nested\": {\"x\": [1, 2, {\"y\": false}]}}";
+    }
+    return doc + "]";
+}
+    
+void benchJson(bench::Counters& counters)
+{
+    static const std::string input = jsonInput();
+    static JsonGrammar grammar;
+
+    TextState state(input);
+    grammar.d_values = 0;
+    RCode rc = grammar.d_value(state, false);
+    assert(RCode::SUCCESS == rc && state.getPos() == input.size());
+    bench::keep(rc);
+    counters.d_bytes += input.size();
+    counters.d_items += grammar.d_values;
+    counters.d_calls += state.d_calls;
+}
+bench::Registrar s_json("combinators/json", &benchJson);
+
+// Arithmetic expressions, evaluated through the cache.
+struct ExprGrammar
+{
+    Cbnt::Parser d_expr;
+
+    static Cbnt::Parser binary(Cbnt::Parser operand, char op1, char op2)
+    {
+        return
+            [operand, op1, op2](TextState& s, bool must)->RCode
+            {
+                if(RCode::FAIL == operand(s, must)) return RCode::FAIL;
+                long long lhs = s.cache().get<long long>();
+                while(s.isValid() && (s.peek() == op1 || s.peek() == op2))
+                {
+                    char op = s.peek();
+                    auto pos = s.getPos();
+                    s.next();
+                    if(RCode::FAIL == operand(s, false))
+                    {
+                        s.setPos(pos);
+                        break;
+                    }
+                    long long rhs = s.cache().get<long long>();
+                    lhs =
+                        op == '+' ? lhs + rhs :
+                        op == '-' ? lhs - rhs :
+                        op == '*' ? lhs * rhs :
+                        rhs ? lhs / rhs : 0;
+                }
+                s.cache().set(lhs);
+                return RCode::SUCCESS;
+            };
+    }
+    
+    ExprGrammar()
+    {
+        Cbnt::Parser number =
+            [](TextState& s, bool must)->RCode
+            {
+                if(!s.isValid() || s.peek() < '0' || s.peek() > '9')
+                {
+                    return RCode::FAIL;
+                }
+                long long v = 0;
+                while(s.isValid() && s.peek() >= '0' && s.peek() <= '9')
+                {
+                    v = v * 10 + (s.peek() - '0');
+                    s.next();
+                }
+                s.cache().set(v);
+                return RCode::SUCCESS;
+            };
+        Cbnt::Parser factor =
+            Cbnt::choice({
+                number,
+                Cbnt::seq({ ch('('), recurse(d_expr), ch(')') })
+            });
+        Cbnt::Parser term = binary(factor, '*', '/');
+        d_expr = binary(term, '+', '-');
+    }
+};
+    
+void benchExpr(bench::Counters& counters)
+{
+    static std::string input;
+    if(input.empty())
+    {
+        for(int i = 0; i < 2000; ++i)
+        {
+            if(i) input += i % 3 ? "+" : "-";
+            input += "(" + std::to_string(i) + "*3+17)/2*(4-1)";
+        }
+    }
+    static ExprGrammar grammar;
+
+    TextState state(input);
+    RCode rc = grammar.d_expr(state, false);
+    assert(RCode::SUCCESS == rc && state.getPos() == input.size());
+    bench::keep(rc);
+    bench::keep(state.cache().get<long long>());
+    counters.d_bytes += input.size();
+    counters.d_items += 2000;
+    counters.d_calls += state.d_calls;
+}
+bench::Registrar s_expr("combinators/expr", &benchExpr);
+
+Cbnt::Parser opParser(char c)
+{
+    return
+        [c](TextState& s, bool must)->RCode
+        {
+            if(s.isValid() && s.peek() == c)
+            {
+                s.cache().set(c);
+                s.next();
+                return RCode::SUCCESS;
+            }
+            return RCode::FAIL;
+        };
+}
+    
+void benchOperators(bench::Counters& counters)
+{
+    static std::string input;
+    if(input.empty())
+    {
+        for(int i = 0; i < 2000; ++i)
+        {
+            if(i) input += i % 3 ? "+" : "-";
+            input += std::to_string(i) + "*3+17/2*4-1";
+        }
+    }
+    static const Cbnt::Parser expr =
+        Cbnt::operators(
+            Cbnt::plus(range('0', '9')),
+            {
+                Cbnt::Operator{ opParser('+'), 1, Cbnt::Assoc::LEFT },
+                Cbnt::Operator{ opParser('-'), 1, Cbnt::Assoc::LEFT },
+                Cbnt::Operator{ opParser('*'), 2, Cbnt::Assoc::LEFT },
+                Cbnt::Operator{ opParser('/'), 2, Cbnt::Assoc::LEFT }
+            },
+            [](TextState& s, const Any&, const Any& op, const Any&) {
+                s.cache().set(op.get<char>());
+            });
+
+    TextState state(input);
+    RCode rc = expr(state, false);
+    assert(RCode::SUCCESS == rc && state.getPos() == input.size());
+    bench::keep(rc);
+    counters.d_bytes += input.size();
+    counters.d_items += 2000;
+    counters.d_calls += state.d_calls;
+}
+bench::Registrar s_operators("combinators/operators", &benchOperators);
+
+// Number lists summed through the cache and through the value stack.
+using VCbnt = Combinators<TextState, long long>;
+
+long long number(const std::string& text,
+                 std::size_t begin,
+                 std::size_t end)
+{
+    long long v = 0;
+    for(std::size_t i = begin; i < end; ++i) v = v * 10 + (text[i] - '0');
+    return v;
+}
+
+std::string listInput()
+{
+    std::string text;
+    for(int i = 0; i < 20000; ++i)
+    {
+        if(i) text += ",";
+        text += std::to_string(i * 7919 % 100000);
+    }
+    return text;
+}
+
+void benchList(bench::Counters& counters, bool stack)
+{
+    static const std::string input = listInput();
+    static long long value = 0;
+    static long long total = 0;
+    static const Cbnt::Parser digits = Cbnt::plus(range('0', '9'));
+    static const Cbnt::Parser cached =
+        [](TextState& s, bool must)->RCode
+        {
+            auto begin = s.getPos();
+            if(RCode::FAIL == digits(s, must)) return RCode::FAIL;
+            s.cache().set(number(s.text(), begin, s.getPos()));
+            return RCode::SUCCESS;
+        };
+    static const Cbnt::Parser item =
+        Cbnt::seq({
+            cached,
+            Cbnt::yaction(Cbnt::capture<long long>(value)),
+            Cbnt::yaction([](TextState&) { total += value; })
+        });
+    static const Cbnt::Parser viaCache =
+        Cbnt::seq({
+            Cbnt::yaction([](TextState&) { total = 0; }),
+            item,
+            Cbnt::star(Cbnt::seq({ ch(','), item }))
+        });
+    static const Cbnt::Parser pushed =
+        VCbnt::push(digits, [](TextState& s, std::size_t begin) {
+                return number(s.text(), begin, s.getPos());
+            });
+    static const Cbnt::Parser viaStack =
+        VCbnt::fold(
+            VCbnt::seq({
+                pushed,
+                Cbnt::star(VCbnt::seq({ ch(','), pushed }))
+            }),
+            [](TextState&, long long* first, long long* last) {
+                long long sum = 0;
+                for(; first != last; ++first) sum += *first;
+                return sum;
+            });
+
+    TextState state(input);
+    RCode rc = (stack ? viaStack : viaCache)(state, false);
+    assert(RCode::SUCCESS == rc && state.getPos() == input.size());
+    bench::keep(rc);
+    bench::keep(state.values());
+    counters.d_bytes += input.size();
+    counters.d_items += 20000;
+    counters.d_calls += state.d_calls;
+}
+bench::Registrar s_listCache(
+    "combinators/list_cache",
+    [](bench::Counters& c) { benchList(c, false); });
+bench::Registrar s_listValues(
+    "combinators/list_values",
+    [](bench::Counters& c) { benchList(c, true); });
+
+// Backtracking: rule N is 'N-1 x / N-1 y', so a mismatch at the end
+// costs 2^N re-parses unless rules are memoized.
+Cbnt::Parser backtrackGrammar(int depth, bool memo)
+{
+    Cbnt::Parser rule = Cbnt::plus(ch('a'));
+    for(int i = 0; i < depth; ++i)
+    {
+        if(memo) rule = Cbnt::memo(rule);
+        rule =
+            Cbnt::choice({
+                Cbnt::seq({ rule, ch('x') }),
+                Cbnt::seq({ rule, ch('y') })
+            });
+    }
+    return Cbnt::seq({ rule, ch('z') });
+}
+
+void benchBacktrack(bench::Counters& counters, bool memo)
+{
+    static const std::string input = std::string(64, 'a') + "yyyyyyyyyyz";
+    static const Cbnt::Parser plain = backtrackGrammar(12, false);
+    static const Cbnt::Parser memoized = backtrackGrammar(12, true);
+
+    TextState state(input);
+    RCode rc = (memo ? memoized : plain)(state, false);
+    bench::keep(rc);
+    counters.d_bytes += input.size();
+    counters.d_items += 1;
+    counters.d_calls += state.d_calls;
+}
+bench::Registrar s_backtrack(
+    "combinators/backtrack",
+    [](bench::Counters& c) { benchBacktrack(c, false); });
+bench::Registrar s_backtrackMemo(
+    "combinators/backtrack_memo",
+    [](bench::Counters& c) { benchBacktrack(c, true); });
+
+// Token stream, as in yapeg_combinators.t.cpp.
+using Token = std::pair<std::string, std::string>;
+    
+class TokenState
+{
+private:
+    // DATA
+    const std::vector<Token>& d_tokens;
+    std::size_t d_pos;
+    Any d_cache;
+
+public:
+    // DATA
+    mutable std::size_t d_calls;
+    
+    // CREATORS
+    explicit TokenState(const std::vector<Token>& tokens)
+        : d_tokens(tokens)
+        , d_pos(0)
+        , d_calls(0) {}
+
+    // MANIPULATORS
+    void next() { ++d_pos; }
+
+    void setPos(std::size_t pos) { d_pos = pos; }
+
+    Any& cache() { return d_cache; }
+
+    // ACCESSORS
+    bool isValid() const { return d_pos < d_tokens.size(); }
+
+    const Token& token() const { return d_tokens[d_pos]; }
+
+    std::size_t getPos() const
+    {
+        ++d_calls;
+        return d_pos;
+    }
+};
+
+using TCbnt = Combinators<TokenState>;
+
+TCbnt::Parser tokenParser(const std::string& tokenType)
+{
+    return
+        TCbnt::normalize(
+            [tokenType](TokenState& s, bool must)->TCbnt::RCode
+            {
+                if(s.isValid() && s.token().first == tokenType)
+                {
+                    s.cache().set(Token(s.token()));
+                    s.next();
+                    return TCbnt::RCode::SUCCESS;
+                }
+                return TCbnt::RCode::FAIL;
+            });
+}
+
+void benchTokens(bench::Counters& counters)
+{
+    static std::vector<Token> tokens;
+    if(tokens.empty())
+    {
+        for(int i = 0; i < 5000; ++i)
+        {
+            tokens.push_back(Token("ident", "x" + std::to_string(i)));
+            tokens.push_back(Token("assign", "="));
+            tokens.push_back(
+                i % 2 ?
+                Token("int", std::to_string(i)) :
+                Token("string", "value"));
+            tokens.push_back(Token("semi", ";"));
+        }
+    }
+    static std::size_t values = 0;
+    static const TCbnt::Parser grammar =
+        TCbnt::star(
+            TCbnt::seq({
+                tokenParser("ident"),
+                tokenParser("assign"),
+                TCbnt::choice({
+                    tokenParser("double"),
+                    tokenParser("float"),
+                    tokenParser("int"),
+                    tokenParser("string")
+                }, [](TokenState&) { ++values; }),
+                tokenParser("semi")
+            }));
+
+    TokenState state(tokens);
+    grammar(state, false);
+    assert(state.getPos() == tokens.size());
+    counters.d_items += tokens.size();
+    counters.d_calls += state.d_calls;
+}
+bench::Registrar s_tokens("combinators/tokens", &benchTokens);
+
+// Grammar construction: level N is 'N+1 (op N+1)*' over 400 levels,
+// the last one a digit or a parenthesized level 0, so each level holds
+// its next level twice.
+Cbnt::Parser layeredGrammar(Cbnt::Rule& top)
+{
+    const int k_LEVELS = 400;
+    Cbnt::Parser next =
+        Cbnt::choice({
+            range('0', '9'),
+            Cbnt::seq({ ch('('), top, ch(')') })
+        });
+    for(int i = k_LEVELS - 1; i >= 0; --i)
+    {
+        Cbnt::Parser op = ch(static_cast<char>('!' + i % 64));
+        next = Cbnt::seq({ next, Cbnt::star(Cbnt::seq({ op, next })) });
+    }
+    top.define(next);
+    return top;
+}
+
+void benchBuild(bench::Counters& counters)
+{
+    static const std::string input = "((7))";
+
+    Cbnt::Rule top;
+    Cbnt::Parser grammar = layeredGrammar(top);
+    TextState state(input);
+    RCode rc = grammar(state, false);
+    assert(RCode::SUCCESS == rc && state.getPos() == input.size());
+    bench::keep(rc);
+    top.reset();
+    counters.d_bytes += input.size();
+    counters.d_items += 400;
+    counters.d_calls += state.d_calls;
+}
+bench::Registrar s_build("combinators/build", &benchBuild);
+    
+} // close anonymous namespace
+    
+} // close namespace yapeg
@@ -1,14 +1,268 @@
 #ifndef INCLUDED_YAPEG_COMBINATORS_H
 #define INCLUDED_YAPEG_COMBINATORS_H
 
+#include <yapeg_ast.h>
+#include <yapeg_memo.h>
+#include <yapeg_profile.h>
+#include <algorithm>
 #include <functional>
 #include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace yapeg {
 
+namespace combinators_impl {
+
+template<typename State, typename = void>
+struct HasMemoTable: public std::false_type {};
+template<typename State>
+struct HasMemoTable<
+    State,
+    decltype(std::declval<State&>().memoTable(), void())>
+    : public std::true_type {};
+
+template<typename State, typename = void>
+struct HasPin: public std::false_type {};
+template<typename State>
+struct HasPin<
+    State,
+    decltype(std::declval<State&>().pin(std::declval<State&>().getPos()),
+             std::declval<State&>().unpin(std::declval<State&>().getPos()),
+             void())>
+    : public std::true_type {};
+
+template<typename State, typename = void>
+struct HasAst: public std::false_type {};
+template<typename State>
+struct HasAst<
+    State,
+    decltype(std::declval<State&>().ast(), void())>
+    : public std::true_type {};
+
+// Size of the Ast of a State when a frame started, to which the frame
+// rewinds the Ast when it backtracks; empty if the State has no Ast.
+template<typename State, bool = HasAst<State>::value>
+class AstMark
+{
+public:
+    // CREATORS
+    explicit AstMark(State&) {}
+
+    // ACCESSORS
+    void rewind(State&) const {}
+
+    void record(State&, std::vector<Ast::Node>&) const {}
+
+    void replay(State&, const std::vector<Ast::Node>&) const {}
+};
+
 template<typename State>
-struct Combinators
+class AstMark<State, true>
+{
+    // DATA
+    std::size_t d_size;
+
+public:
+    // CREATORS
+    explicit AstMark(State& state)
+        : d_size(state.ast() ? state.ast()->size() : 0) {}
+
+    // ACCESSORS
+
+    // Drop the nodes added to the Ast of 'state' since the mark.
+    void rewind(State& state) const
+    {
+        if(Ast* ast = state.ast())
+        {
+            ast->rewind(d_size);
+        }
+    }
+
+    // Load 'nodes' with the nodes added since the mark.
+    void record(State& state, std::vector<Ast::Node>& nodes) const
+    {
+        if(Ast* ast = state.ast())
+        {
+            nodes = ast->subtrees(d_size);
+        }
+    }
+
+    // Add the 'nodes' of a record to the Ast of 'state'.
+    void replay(State& state, const std::vector<Ast::Node>& nodes) const
+    {
+        if(Ast* ast = state.ast())
+        {
+            ast->replay(nodes);
+        }
+    }
+};
+
+// Charge the rewind of 'state' to 'pos' to the current Profiler.
+template<typename State, typename Pos>
+inline void profileRewind(State& state, const Pos& pos)
+{
+#ifdef YAPEG_PROFILE
+    if(Profiler* profiler = Profiler::current())
+    {
+        profiler->rewound(static_cast<std::size_t>(state.getPos() - pos));
+    }
+#endif
+}
+
+// Position saved by a frame that may rewind to it, with the size of the
+// State's Ast.  If the State can release input (see HasPin), the
+// position is pinned for the lifetime of the frame.
+template<typename State, bool = HasPin<State>::value>
+class SavedPos
+{
+public:
+    // TYPES
+    using Pos = typename std::decay<
+        decltype(std::declval<State&>().getPos())>::type;
+
+private:
+    // DATA
+    Pos d_pos;
+    AstMark<State> d_ast;
+    bool d_released;
+
+public:
+    // CREATORS
+    explicit SavedPos(State& state)
+        : d_pos(state.getPos())
+        , d_ast(state)
+        , d_released(false) {}
+    SavedPos(const SavedPos&) = delete;
+    SavedPos& operator= (const SavedPos&) = delete;
+
+    // MANIPULATORS
+
+    // Give up the right to rewind to the position.
+    void release() { d_released = true; }
+    
+    // ACCESSORS
+    const Pos& get() const { return d_pos; }
+
+    const AstMark<State>& ast() const { return d_ast; }
+
+    bool isReleased() const { return d_released; }
+
+    // Move 'state' back to the position, and its Ast back to its size.
+    void rewind(State& state) const
+    {
+        profileRewind(state, d_pos);
+        state.setPos(d_pos);
+        d_ast.rewind(state);
+    }
+};
+
+template<typename State>
+class SavedPos<State, true>
+{
+public:
+    // TYPES
+    using Pos = typename std::decay<
+        decltype(std::declval<State&>().getPos())>::type;
+
+private:
+    // DATA
+    State& d_state;
+    Pos d_pos;
+    AstMark<State> d_ast;
+    bool d_released;
+
+public:
+    // CREATORS
+    explicit SavedPos(State& state)
+        : d_state(state)
+        , d_pos(state.getPos())
+        , d_ast(state)
+        , d_released(false)
+    {
+        d_state.pin(d_pos);
+    }
+    SavedPos(const SavedPos&) = delete;
+    SavedPos& operator= (const SavedPos&) = delete;
+
+    ~SavedPos()
+    {
+        release();
+    }
+
+    // MANIPULATORS
+
+    // Give up the right to rewind to the position and unpin it.
+    void release()
+    {
+        if(!d_released)
+        {
+            d_state.unpin(d_pos);
+            d_released = true;
+        }
+    }
+
+    // ACCESSORS
+    const Pos& get() const { return d_pos; }
+
+    const AstMark<State>& ast() const { return d_ast; }
+
+    bool isReleased() const { return d_released; }
+
+    // Move 'state' back to the position, and its Ast back to its size.
+    void rewind(State& state) const
+    {
+        profileRewind(state, d_pos);
+        state.setPos(d_pos);
+        d_ast.rewind(state);
+    }
+};
+    
+// Compile-time index list 0..N-1.
+template<std::size_t... I>
+struct Indices {};
+
+template<std::size_t N, std::size_t... I>
+struct MakeIndices: public MakeIndices<N - 1, N - 1, I...> {};
+
+template<std::size_t... I>
+struct MakeIndices<0, I...>
+{
+    using type = Indices<I...>;
+};
+
+} // close namespace combinators_impl
+
+// Thrown by seq when a parser after its cut fails without throwing, as
+// user parsers, ntest and leaves recording failures instead of throwing
+// them may do: the failure is committed, so no enclosing choice may try
+// another alternative, and the input before the cut may be released.
+class CutFailure: public std::runtime_error
+{
+public:
+    // CREATORS
+    CutFailure()
+        : std::runtime_error("failure after cut") {}
+};
+
+template<typename State>
+class Grammar;
+
+// Combinators<State> passes values between parsers through the single
+// Any of 'State::cache()'; Combinators<State, Value> adds a typed value
+// stack (see below).
+template<typename State, typename Value = void>
+struct Combinators;
+
+template<typename State>
+struct Combinators<State, void>
 {
     
 // TYPES
@@ -23,21 +277,138 @@ enum class RCode {
 //     - auto getPos()
 //   + Cache
 //     - Any& cache()
+//       (an Any constructed with an Arena owned by the State makes
+//        invoke and the parsers allocate their payloads from it)
+//   + Memo (optional, enables memo)
+//     - MemoTable<Pos>& memoTable()
+//   + Pin (optional, for States that release consumed input)
+//     - void pin(Pos), void unpin(Pos)
+//       bracket every frame that may rewind to Pos; frames nest, so
+//       pins and unpins come in stack order
+//   + Ast (optional, enables node)
+//     - Ast* ast()
+//       null to build no tree; SavedPos rewinds it
     
 using Parser = std::function<RCode (State&, bool)>;
 using Actor = std::function<void (State&)>;
-    
+using SavedPos = combinators_impl::SavedPos<State>;
+
+enum class Assoc {
+    LEFT
+  , RIGHT
+};
+
+// A binary operator for 'operators'; a higher precedence binds tighter,
+// and any int is a precedence.
+struct Operator
+{
+    Parser d_parser;
+    int d_precedence;
+    Assoc d_assoc;
+};
+
+// Handle on a parser that can be used before it is defined, for
+// recursive grammars.  Copies share one definition through a reference
+// counted pointer, so a Rule converted to a Parser and copied into any
+// number of combinators costs one pointer, never a copy of the
+// definition.  A rule referring to itself, directly or through other
+// rules, keeps its definition alive in a cycle; call 'reset' on one
+// rule of the cycle to release it.  Calling an undefined rule throws
+// std::bad_function_call.  The rules of a Grammar are frozen: 'define'
+// and 'reset' throw std::logic_error, and the Grammar resets them when
+// it goes away.
+class Rule
+{
+    // TYPES
+    struct Definition
+    {
+        Parser d_parser;
+        bool d_frozen;
+    };
+
+    // DATA
+    std::shared_ptr<Definition> d_def;
+
+    // FRIENDS
+    template<typename>
+    friend class Grammar;
+
+    // MANIPULATORS
+    void freeze()
+    {
+        d_def->d_frozen = true;
+    }
+
+    // Drop the definition of a frozen rule, once nothing parses with it.
+    void release()
+    {
+        d_def->d_parser = Parser();
+    }
+
+    void checkNotFrozen(const char* message) const
+    {
+        if(d_def->d_frozen)
+        {
+            throw std::logic_error(message);
+        }
+    }
+
+public:
+    // CREATORS
+    Rule()
+        : d_def(std::make_shared<Definition>()) {}
+
+    explicit Rule(Parser parser)
+        : d_def(std::make_shared<Definition>())
+    {
+        d_def->d_parser = std::move(parser);
+    }
+
+    // MANIPULATORS
+
+    // Set the definition seen by all copies of this rule.
+    void define(Parser parser)
+    {
+        checkNotFrozen("define: rule is frozen");
+        d_def->d_parser = std::move(parser);
+    }
+
+    // Drop the definition seen by all copies, breaking the cycles it
+    // is part of.
+    void reset()
+    {
+        checkNotFrozen("reset: rule is frozen");
+        release();
+    }
+
+    // ACCESSORS
+    bool isDefined() const
+    {
+        return static_cast<bool>(d_def->d_parser);
+    }
+
+    bool isFrozen() const
+    {
+        return d_def->d_frozen;
+    }
+
+    RCode operator() (State& state, bool must) const
+    {
+        return d_def->d_parser(state, must);
+    }
+};
+
 // FUNCTIONS
 static Parser normalize(Parser parser)
 {
     return
         [parser](State& state, bool must)->RCode
         {
-            auto pos = state.getPos();
+            SavedPos pos(state);
             RCode rc = parser(state, must);
             if(RCode::SUCCESS != rc)
             {
-                state.setPos(pos);
+                pos.rewind(state);
             }
             return rc;
         };
@@ -48,9 +419,9 @@ static Parser action(Actor actor, RCode rc)
     return
         [actor, rc](State& state, bool must)->RCode
         {
-            auto pos = state.getPos();
+            SavedPos pos(state);
             actor(state);
-            state.setPos(pos);
+            pos.rewind(state);
             return rc;
         };
 }
@@ -65,17 +436,21 @@ static Parser naction(Actor actor)
     return action(actor, RCode::FAIL);
 }
 
+// Set 'ans' as the cache value if 'parser' succeeds; an rvalue 'ans' is
+// moved into the cache.
 template<typename Ans>
-static RCode invoke(Parser parser, State& state, bool must, Ans& ans)
+static RCode invoke(Parser parser, State& state, bool must, Ans&& ans)
 {
     RCode rc = parser(state, must);
     if(RCode::FAIL != rc)
     {
-        state.cache().set(ans);
+        state.cache().set(std::forward<Ans>(ans));
     }
     return rc;
 }
 
+// Bind 'ans' by reference; a grammar using it must not be shared by
+// threads (see Grammar).
 template<typename CacheType, typename Ans>
 static Actor capture(Ans& ans)
 {
@@ -85,18 +460,113 @@ static Actor capture(Ans& ans)
             ans = state.cache().template get<CacheType>();
         };
 }
+
+// Same as capture, but move the cache value into 'ans', leaving the
+// cache empty.
+template<typename CacheType, typename Ans>
+static Actor captureMove(Ans& ans)
+{
+    return
+        [&ans](State& state)
+        {
+            ans = state.cache().template take<CacheType>();
+        };
+}
     
-static Parser seq(const std::vector<Parser>& parsers)
+// Return 'actor', checking at compile time that it holds no data (a
+// captureless lambda, an empty function object or a function pointer),
+// so that a grammar using it keeps all mutable results in the State.
+template<typename F>
+static Actor pure(F actor)
 {
+    static_assert(
+        std::is_empty<F>::value ||
+        std::is_function<typename std::remove_pointer<F>::type>::value,
+        "a pure actor must not capture data");
+    return actor;
+}
+    
+// Name 'parser' as a rule whose calls, results, consumed and rewound
+// positions and time are counted by the Profiler of the calling thread.
+// Unless YAPEG_PROFILE is defined this returns 'parser' itself; when it
+// is, positions must be integral.
+static Parser named(const std::string& name, Parser parser)
+{
+#ifdef YAPEG_PROFILE
+    std::size_t rule = Profiler::nextRuleId();
     return
-        [parsers](State& state, bool must)->RCode
+        [name, parser, rule](State& state, bool must)->RCode
         {
+            Profiler* profiler = Profiler::current();
+            if(!profiler)
+            {
+                return parser(state, must);
+            }
+            Profiler::Call call(*profiler, rule, name);
             auto pos = state.getPos();
-            for(auto it = parsers.begin(); it != parsers.end(); ++it)
+            RCode rc = parser(state, must);
+            call.finish(
+                RCode::SUCCESS == rc,
+                static_cast<std::size_t>(state.getPos() - pos));
+            return rc;
+        };
+#else
+    return parser;
+#endif
+}
+    
+// Marker for seq: the parsers after a cut are called with 'must' set,
+// so their failures are hard errors instead of letting an enclosing
+// choice try its remaining alternatives, and the seq stops keeping its
+// start position (a State releasing input may drop it).  A parser after
+// the cut that fails without throwing makes the seq throw CutFailure
+// rather than return FAIL, so a seq never returns FAIL after its cut.
+// Outside a seq a cut always succeeds.
+struct Cut
+{
+    RCode operator() (State& state, bool must) const
+    {
+        return RCode::SUCCESS;
+    }
+};
+    
+static Parser cut()
+{
+    return Cut();
+}
+    
+static Parser seq(const std::vector<Parser>& parsers)
+{
+    std::size_t cut = parsers.size();
+    for(std::size_t i = 0; i < parsers.size(); ++i)
+    {
+        if(parsers[i].template target<Cut>())
+        {
+            cut = i;
+            break;
+        }
+    }
+    // copies of the parser share its elements
+    auto shared = std::make_shared<const std::vector<Parser> >(parsers);
+    return
+        [shared, cut](State& state, bool must)->RCode
+        {
+            const std::vector<Parser>& parsers = *shared;
+            SavedPos pos(state);
+            for(std::size_t i = 0; i < parsers.size(); ++i)
             {
-                if(RCode::FAIL == (*it)(state, must))
+                if(i == cut)
                 {
-                    state.setPos(pos);
+                    pos.release();
+                    must = true;
+                }
+                else if(RCode::FAIL == parsers[i](state, must))
+                {
+                    if(pos.isReleased())
+                    {
+                        throw CutFailure();
+                    }
+                    pos.rewind(state);
                     return RCode::FAIL;
                 }
             }
@@ -111,9 +581,11 @@ static Parser combo(Parser parser, Actor actor)
     
 static Parser choice(const std::vector<Parser>& parsers)
 {
+    auto shared = std::make_shared<const std::vector<Parser> >(parsers);
     return
-        [parsers](State& state, bool must)->RCode
+        [shared](State& state, bool must)->RCode
         {
+            const std::vector<Parser>& parsers = *shared;
             for(auto it = parsers.begin(); it != parsers.end(); ++it)
             {
                 if(RCode::SUCCESS ==
@@ -130,6 +602,76 @@ static Parser choice(const std::vector<Parser>& parsers, Actor actor)
 {
     return seq({ choice(parsers), yaction(actor) });
 }
+
+// Ordered choice over alternatives paired with the keys (tokens, first
+// characters, ...) they can start with; an empty key set means the
+// alternative may start with anything, including nothing.  'peek'
+// yields the key at the current position and returns false at the end
+// of input.  Only the alternatives whose set holds that key are tried,
+// in their original order.  Keys must be hashable.
+template<typename Key>
+static Parser dispatch(
+    std::function<bool (State&, Key&)> peek,
+    const std::vector<std::pair<std::vector<Key>, Parser> >& alternatives)
+{
+    using Table = std::unordered_map<Key, Parser>;
+    auto table = std::make_shared<Table>();
+    std::vector<Parser> wildcards;
+    for(auto it = alternatives.begin(); it != alternatives.end(); ++it)
+    {
+        if(it->first.empty())
+        {
+            wildcards.push_back(it->second);
+        }
+        for(auto key = it->first.begin(); key != it->first.end(); ++key)
+        {
+            (*table)[*key];
+        }
+    }
+    for(auto entry = table->begin(); entry != table->end(); ++entry)
+    {
+        std::vector<Parser> bucket;
+        for(auto it = alternatives.begin(); it != alternatives.end(); ++it)
+        {
+            if(it->first.empty() ||
+               std::find(it->first.begin(), it->first.end(), entry->first)
+               != it->first.end())
+            {
+                bucket.push_back(it->second);
+            }
+        }
+        entry->second = 1 == bucket.size() ? bucket[0] : choice(bucket);
+    }
+    Parser fallback;
+    if(wildcards.empty() && !alternatives.empty())
+    {
+        // like choice, let the last alternative report the failure
+        Parser last = alternatives.back().second;
+        fallback =
+            [last](State& state, bool must)->RCode
+            {
+                return must ? last(state, must) : RCode::FAIL;
+            };
+    }
+    else
+    {
+        fallback = 1 == wildcards.size() ? wildcards[0] : choice(wildcards);
+    }
+    return
+        [peek, table, fallback](State& state, bool must)->RCode
+        {
+            Key key;
+            if(peek(state, key))
+            {
+                auto it = table->find(key);
+                if(it != table->end())
+                {
+                    return it->second(state, must);
+                }
+            }
+            return fallback(state, must);
+        };
+}
     
 static Parser star(Parser parser)
 {
@@ -141,9 +683,22 @@ static Parser star(Parser parser)
         };
 }
 
+// Same as seq({parser, star(parser)}), holding one copy of 'parser'.
 static Parser plus(Parser parser)
 {
-    return seq({parser, star(parser)});
+    return
+        [parser](State& state, bool must)->RCode
+        {
+            SavedPos pos(state);
+            if(RCode::FAIL == parser(state, must))
+            {
+                pos.rewind(state);
+                return RCode::FAIL;
+            }
+            pos.release();
+            while(RCode::FAIL != parser(state, false)) ;
+            return RCode::SUCCESS;
+        };
 }
 
 static Parser qmark(Parser parser)
@@ -161,9 +716,9 @@ static Parser ptest(Parser parser)
     return
         [parser](State& state, bool must)->RCode
         {
-            auto pos = state.getPos();
+            SavedPos pos(state);
             RCode rc = parser(state, false);
-            state.setPos(pos);
+            pos.rewind(state);
             return
                 RCode::FAIL == rc ?
                 RCode::FAIL : RCode::SUCCESS;
@@ -175,15 +730,621 @@ static Parser ntest(Parser parser)
     return
         [parser](State& state, bool must)->RCode
         {
-            auto pos = state.getPos();
+            SavedPos pos(state);
             RCode rc = parser(state, false);
-            state.setPos(pos);
+            pos.rewind(state);
             return
                 RCode::SUCCESS == rc ?
                 RCode::FAIL : RCode::SUCCESS;
         };
 }
 
+// Parse 'operand (op operand)*' over the binary operators in 'table' by
+// precedence climbing.  'combine(state, lhs, op, rhs)' is called for
+// each reduction with the cache values left by the operands and the
+// operator parser, and must set 'state.cache()' to the result; the
+// cache then holds the value of the whole expression.  An operator not
+// followed by an operand is left unconsumed.
+template<typename Combine>
+static Parser operators(Parser operand,
+                        const std::vector<Operator>& table,
+                        Combine combine)
+{
+    auto ops = std::make_shared<const std::vector<Operator> >(table);
+    return
+        [operand, ops, combine](State& state, bool must)->RCode
+        {
+            return climb(operand, *ops, combine, state, must,
+                         std::numeric_limits<int>::min());
+        };
+}
+    
+// Add a node of 'kind' spanning the input matched by 'parser' to the
+// State's Ast, with the nodes added by 'parser' as its children.  The
+// node is dropped if 'parser' fails, and by any enclosing frame that
+// backtracks over it.  Positions must be integral.  memo records the
+// nodes added by a success and replays them on a hit.
+static Parser node(int kind, Parser parser)
+{
+    return
+        [kind, parser](State& state, bool must)->RCode
+        {
+            Ast* ast = state.ast();
+            if(!ast)
+            {
+                return parser(state, must);
+            }
+            std::size_t index =
+                ast->open(kind, static_cast<std::size_t>(state.getPos()));
+            RCode rc;
+            try
+            {
+                rc = parser(state, must);
+            }
+            catch(...)
+            {
+                ast->abandon(index);
+                throw;
+            }
+            if(RCode::FAIL == rc)
+            {
+                ast->abandon(index);
+            }
+            else
+            {
+                ast->close(index, static_cast<std::size_t>(state.getPos()));
+            }
+            return rc;
+        };
+}
+
+// Memoize 'parser' per position: a repeated call at the same position
+// restores the recorded result, end position, cache value and Ast nodes
+// instead of re-parsing.  Actors inside 'parser' are not re-run on a
+// hit.  Without a State memo table this is equivalent to normalize.
+//
+// With a memo table, left-recursive rules are supported by growing a
+// seed: a recursive call at the position being evaluated fails at first,
+// then 'parser' is re-run with the previous result as the answer of that
+// call for as long as it consumes more input.  Actors inside the rule
+// run once per growing round.  For indirect recursion every memoized
+// rule in the cycle is re-evaluated while the head grows.
+static Parser memo(Parser parser)
+{
+    return memo(parser, combinators_impl::HasMemoTable<State>());
+}
+
+private:
+static Parser memo(Parser parser, std::false_type)
+{
+    return normalize(parser);
+}
+
+static Parser memo(Parser parser, std::true_type)
+{
+    std::size_t rule = nextMemoRuleId();
+    return
+        [parser, rule](State& state, bool must)->RCode
+        {
+            auto& table = state.memoTable();
+            SavedPos saved(state);
+            const auto& pos = saved.get();
+            auto* entry = table.find(rule, pos);
+            if(entry &&
+               (entry->d_inProgress || !table.isGrowing(rule, pos)))
+            {
+                if(entry->d_inProgress)
+                {
+                    entry->d_leftRec = true;
+                }
+                if(entry->d_success)
+                {
+                    // forward to the recorded end, not a rewind
+                    state.setPos(entry->d_end);
+                    state.cache() = entry->d_value;
+                    saved.ast().replay(state, entry->d_nodes);
+                    return RCode::SUCCESS;
+                }
+                if(!must || entry->d_inProgress)
+                {
+                    return RCode::FAIL;
+                }
+                // re-run so that the failure is reported
+            }
+
+            entry = &table.insert(rule, pos);
+            entry->d_success = false;
+            entry->d_end = pos;
+            entry->d_inProgress = true;
+            entry->d_leftRec = false;
+            RCode rc;
+            try
+            {
+                rc = parser(state, must);
+                entry = table.find(rule, pos);
+                if(RCode::SUCCESS == rc && entry->d_leftRec)
+                {
+                    grow(parser, rule, saved, state);
+                    entry = table.find(rule, pos);
+                }
+            }
+            catch(...)
+            {
+                table.erase(rule, pos);
+                throw;
+            }
+            
+            entry->d_inProgress = false;
+            entry->d_success = RCode::SUCCESS == rc;
+            if(entry->d_success)
+            {
+                entry->d_end = state.getPos();
+                entry->d_value = state.cache();
+                saved.ast().record(state, entry->d_nodes);
+            }
+            else
+            {
+                saved.rewind(state);
+                entry->d_end = pos;
+            }
+            return rc;
+        };
+}
+
+template<typename Combine>
+static RCode climb(const Parser& operand,
+                   const std::vector<Operator>& table,
+                   const Combine& combine,
+                   State& state,
+                   bool must,
+                   int minPrecedence)
+{
+    if(RCode::FAIL == operand(state, must))
+    {
+        return RCode::FAIL;
+    }
+    auto lhs = std::move(state.cache());
+    while(true)
+    {
+        SavedPos pos(state);
+        auto op = table.begin();
+        for(; op != table.end(); ++op)
+        {
+            if(op->d_precedence >= minPrecedence &&
+               RCode::SUCCESS == op->d_parser(state, false))
+            {
+                break;
+            }
+        }
+        if(op == table.end())
+        {
+            break;
+        }
+        auto opValue = std::move(state.cache());
+        int next =
+            Assoc::LEFT == op->d_assoc ?
+            op->d_precedence + 1 : op->d_precedence;
+        if(RCode::FAIL ==
+           climb(operand, table, combine, state, false, next))
+        {
+            pos.rewind(state);
+            break;
+        }
+        auto rhs = std::move(state.cache());
+        combine(state, lhs, opValue, rhs);
+        lhs = std::move(state.cache());
+    }
+    state.cache() = std::move(lhs);
+    return RCode::SUCCESS;
+}
+    
+// Grow the seed left in the State by a successful first evaluation of
+// the left-recursive 'rule' at 'start', leaving the State at the longest
+// match.
+static void grow(const Parser& parser,
+                 std::size_t rule,
+                 const SavedPos& start,
+                 State& state)
+{
+    auto& table = state.memoTable();
+    table.pushHead(rule, start.get());
+    try
+    {
+        while(true)
+        {
+            auto* entry = table.find(rule, start.get());
+            entry->d_success = true;
+            entry->d_end = state.getPos();
+            entry->d_value = state.cache();
+            start.ast().record(state, entry->d_nodes);
+            start.rewind(state);
+            if(RCode::FAIL == parser(state, false) ||
+               !(entry->d_end < state.getPos()))
+            {
+                // forward to the longest match
+                entry = table.find(rule, start.get());
+                start.ast().rewind(state);
+                state.setPos(entry->d_end);
+                state.cache() = entry->d_value;
+                start.ast().replay(state, entry->d_nodes);
+                break;
+            }
+        }
+    }
+    catch(...)
+    {
+        table.popHead();
+        throw;
+    }
+    table.popHead();
+}
+
+}; // close struct Combinators<State, void>
+
+// Combinators with a stack of semantic values of type 'Value' held by
+// the State, in addition to all of Combinators<State>.  Leaf parsers
+// push their results with 'push', and 'reduce' and 'fold' replace the
+// values pushed by a parser with one computed from them, so values are
+// moved from producer to consumer without type checks or boxing.  A
+// parser built from these combinators leaves the stack as it found it
+// when it fails; seq, choice, dispatch, star, plus, qmark, ptest and
+// ntest are redefined to keep that promise, also for alternatives and
+// repetitions that push before failing.  memo records the values pushed
+// by a success and pushes copies on a hit, so it needs a copyable
+// Value, and operators combines values on the stack rather than in the
+// cache.  The combinators not redefined here pass the stack through.
+//
+// class State must also have
+//   + Values
+//     - std::vector<Value>& values()
+template<typename State, typename Value>
+struct Combinators: public Combinators<State, void>
+{
+
+// TYPES
+using Base = Combinators<State, void>;
+using RCode = typename Base::RCode;
+using Parser = typename Base::Parser;
+using SavedPos = typename Base::SavedPos;
+using Pos = typename SavedPos::Pos;
+using Operator = typename Base::Operator;
+using Assoc = typename Base::Assoc;
+
+// FUNCTIONS
+
+// Push 'make(state, begin)' once 'parser' matched from 'begin' to the
+// current position.
+template<typename Make>
+static Parser push(Parser parser, Make make)
+{
+    return
+        [parser, make](State& state, bool must)->RCode
+        {
+            Pos begin = state.getPos();
+            RCode rc = parser(state, must);
+            if(RCode::FAIL != rc)
+            {
+                state.values().push_back(make(state, begin));
+            }
+            return rc;
+        };
+}
+
+// Replace the 'N' values pushed by 'parser' with 'f(state, v1, ...,
+// vN)', the values moved in the order they were pushed.  Throw
+// std::logic_error if 'parser' pushed some other number of values.
+template<std::size_t N, typename F>
+static Parser reduce(Parser parser, F f)
+{
+    return
+        [parser, f](State& state, bool must)->RCode
+        {
+            std::size_t mark = state.values().size();
+            RCode rc = parser(state, must);
+            if(RCode::FAIL == rc)
+            {
+                return rc;
+            }
+            if(state.values().size() - mark != N)
+            {
+                throw std::logic_error("reduce: unexpected value count");
+            }
+            apply(f, state, mark,
+                  typename combinators_impl::MakeIndices<N>::type());
+            return rc;
+        };
+}
+
+// Replace the values pushed by 'parser', however many, with
+// 'f(state, first, last)' over them.
+template<typename F>
+static Parser fold(Parser parser, F f)
+{
+    return
+        [parser, f](State& state, bool must)->RCode
+        {
+            std::vector<Value>& values = state.values();
+            std::size_t mark = values.size();
+            RCode rc = parser(state, must);
+            if(RCode::FAIL == rc)
+            {
+                return rc;
+            }
+            Value result = f(state,
+                             values.data() + mark,
+                             values.data() + values.size());
+            truncate(state, mark);
+            values.push_back(std::move(result));
+            return rc;
+        };
+}
+
+// Drop the values pushed by 'parser'.
+static Parser drop(Parser parser)
+{
+    return
+        [parser](State& state, bool must)->RCode
+        {
+            std::size_t mark = state.values().size();
+            RCode rc = parser(state, must);
+            truncate(state, mark);
+            return rc;
+        };
+}
+
+static Parser seq(const std::vector<Parser>& parsers)
+{
+    Parser base = Base::seq(parsers);
+    return
+        [base](State& state, bool must)->RCode
+        {
+            std::size_t mark = state.values().size();
+            RCode rc = base(state, must);
+            if(RCode::FAIL == rc)
+            {
+                truncate(state, mark);
+            }
+            return rc;
+        };
+}
+
+using Base::choice;
+
+static Parser choice(const std::vector<Parser>& parsers)
+{
+    std::vector<Parser> restoring;
+    for(auto it = parsers.begin(); it != parsers.end(); ++it)
+    {
+        restoring.push_back(restore(*it));
+    }
+    return Base::choice(restoring);
+}
+
+template<typename Key>
+static Parser dispatch(
+    std::function<bool (State&, Key&)> peek,
+    const std::vector<std::pair<std::vector<Key>, Parser> >& alternatives)
+{
+    auto restoring = alternatives;
+    for(auto it = restoring.begin(); it != restoring.end(); ++it)
+    {
+        it->second = restore(it->second);
+    }
+    return Base::dispatch(peek, restoring);
+}
+
+static Parser star(Parser parser)
+{
+    return Base::star(restore(parser));
+}
+
+static Parser plus(Parser parser)
+{
+    return Base::plus(restore(parser));
+}
+
+static Parser qmark(Parser parser)
+{
+    return Base::qmark(restore(parser));
+}
+
+static Parser ptest(Parser parser)
+{
+    return Base::ptest(drop(parser));
+}
+
+static Parser ntest(Parser parser)
+{
+    return Base::ntest(drop(parser));
+}
+
+// Memoize 'parser' as Combinators<State>::memo does, also recording the
+// values it pushes on success and pushing copies of them on a hit.
+static Parser memo(Parser parser)
+{
+    return memo(parser, combinators_impl::HasMemoTable<State>());
+}
+
+// Parse 'operand (op operand)*' by precedence climbing as
+// Combinators<State>::operators does, over the value stack: 'operand'
+// and the operator parsers must each push one value, and 'combine(state,
+// lhs, op, rhs)' replaces the three values of a reduction, moved to it,
+// with the Value it returns.  Throw std::logic_error if one of the
+// parsers pushes some other number of values.
+template<typename Combine>
+static Parser operators(Parser operand,
+                        const std::vector<Operator>& table,
+                        Combine combine)
+{
+    auto ops = std::make_shared<const std::vector<Operator> >(table);
+    return
+        [operand, ops, combine](State& state, bool must)->RCode
+        {
+            return climb(operand, *ops, combine, state, must,
+                         std::numeric_limits<int>::min());
+        };
+}
+
+private:
+// TYPES
+
+// A memoized success: the cache value and the values pushed.
+struct Memoized
+{
+    Any d_cache;
+    std::vector<Value> d_values;
+};
+
+// FUNCTIONS
+static void truncate(State& state, std::size_t mark)
+{
+    std::vector<Value>& values = state.values();
+    values.erase(values.begin() + mark, values.end());
+}
+
+// Return 'parser' dropping the values it pushed if it fails.
+static Parser restore(Parser parser)
+{
+    return
+        [parser](State& state, bool must)->RCode
+        {
+            std::size_t mark = state.values().size();
+            RCode rc = parser(state, must);
+            if(RCode::FAIL == rc)
+            {
+                truncate(state, mark);
+            }
+            return rc;
+        };
+}
+
+static Parser memo(Parser parser, std::false_type)
+{
+    return Base::memo(restore(parser));
+}
+
+static Parser memo(Parser parser, std::true_type)
+{
+    // the table records the pushed values with the cache value, and
+    // they are unpacked from the cache after every success
+    Parser memoized =
+        Base::memo(
+            [parser](State& state, bool must)->RCode
+            {
+                std::vector<Value>& values = state.values();
+                std::size_t mark = values.size();
+                RCode rc = parser(state, must);
+                if(RCode::SUCCESS == rc)
+                {
+                    Memoized result;
+                    result.d_cache = std::move(state.cache());
+                    result.d_values.assign(
+                        std::make_move_iterator(values.begin() + mark),
+                        std::make_move_iterator(values.end()));
+                    state.cache().template emplace<Memoized>(
+                        std::move(result));
+                }
+                truncate(state, mark);
+                return rc;
+            });
+    return
+        [memoized](State& state, bool must)->RCode
+        {
+            RCode rc = memoized(state, must);
+            if(RCode::SUCCESS == rc)
+            {
+                Memoized result = state.cache().template take<Memoized>();
+                std::vector<Value>& values = state.values();
+                values.insert(values.end(),
+                              std::make_move_iterator(
+                                  result.d_values.begin()),
+                              std::make_move_iterator(
+                                  result.d_values.end()));
+                state.cache() = std::move(result.d_cache);
+            }
+            return rc;
+        };
+}
+
+// Run 'parser', which must push one value if it succeeds, for operators.
+static RCode pushOne(const Parser& parser, State& state, bool must)
+{
+    std::size_t mark = state.values().size();
+    RCode rc = parser(state, must);
+    if(RCode::FAIL == rc)
+    {
+        truncate(state, mark);
+    }
+    else if(state.values().size() - mark != 1)
+    {
+        throw std::logic_error("operators: unexpected value count");
+    }
+    return rc;
+}
+
+template<typename Combine>
+static RCode climb(const Parser& operand,
+                   const std::vector<Operator>& table,
+                   const Combine& combine,
+                   State& state,
+                   bool must,
+                   int minPrecedence)
+{
+    if(RCode::FAIL == pushOne(operand, state, must))
+    {
+        return RCode::FAIL;
+    }
+    std::vector<Value>& values = state.values();
+    while(true)
+    {
+        // the left operand is at mark - 1
+        SavedPos pos(state);
+        std::size_t mark = values.size();
+        auto op = table.begin();
+        for(; op != table.end(); ++op)
+        {
+            if(op->d_precedence >= minPrecedence &&
+               RCode::SUCCESS == pushOne(op->d_parser, state, false))
+            {
+                break;
+            }
+        }
+        if(op == table.end())
+        {
+            break;
+        }
+        int next =
+            Assoc::LEFT == op->d_assoc ?
+            op->d_precedence + 1 : op->d_precedence;
+        if(RCode::FAIL ==
+           climb(operand, table, combine, state, false, next))
+        {
+            truncate(state, mark);
+            pos.rewind(state);
+            break;
+        }
+        Value result = combine(state,
+                               std::move(values[mark - 1]),
+                               std::move(values[mark]),
+                               std::move(values[mark + 1]));
+        truncate(state, mark - 1);
+        values.push_back(std::move(result));
+    }
+    return RCode::SUCCESS;
+}
+
+template<typename F, std::size_t... I>
+static void apply(const F& f,
+                  State& state,
+                  std::size_t mark,
+                  combinators_impl::Indices<I...>)
+{
+    std::vector<Value>& values = state.values();
+    Value result = f(state, std::move(values[mark + I])...);
+    truncate(state, mark);
+    values.push_back(std::move(result));
+}
+
 }; // close struct Combinators
     
 } // close namespace yapeg
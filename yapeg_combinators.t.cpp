@@ -1,11 +1,14 @@
 #include <gtest/gtest.h>
 #include <yapeg_combinators.h>
 #include <yapeg_any.h>
+#include <yapeg_memo.h>
+#include <memory>
 #include <vector>
 #include <string>
 #include <utility>
 #include <stdexcept>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 
 namespace yapeg {
@@ -26,6 +29,8 @@ private:
     std::size_t d_pos;
     std::vector<Token> d_tokens;
     Any d_cache;
+    MemoTable<std::size_t> d_memo;
+    std::vector<std::string> d_values;
     
 public:
     // CREATORS
@@ -46,6 +51,10 @@ public:
     }
 
     Any& cache() { return d_cache; }
+
+    MemoTable<std::size_t>& memoTable() { return d_memo; }
+
+    std::vector<std::string>& values() { return d_values; }
     
     // ACCESSORS
     bool isValid() const
@@ -211,6 +220,61 @@ TEST(Combinators, choice)
     EXPECT_EQ(state.getPos(), 3u);
 }
 
+TEST(Combinators, cut)
+{
+    auto alternatives =
+        [](bool cut) {
+            std::vector<Cbnt::Parser> first{ baseParser("int") };
+            if(cut) first.push_back(Cbnt::cut());
+            first.push_back(baseParser("float"));
+            return
+                Cbnt::choice({
+                    Cbnt::seq(first),
+                    Cbnt::seq({ baseParser("int"), baseParser("string") })
+                });
+        };
+
+    State s1({ Token("int", "1"), Token("string", "x") });
+    EXPECT_EQ(alternatives(false)(s1, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(s1.getPos(), 2u);
+    
+    State s2({ Token("int", "1"), Token("string", "x") });
+    EXPECT_THROW(alternatives(true)(s2, false), std::runtime_error);
+    
+    State s3({ Token("int", "1"), Token("float", "2.0") });
+    EXPECT_EQ(alternatives(true)(s3, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(s3.getPos(), 2u);
+
+    State s4({ Token("string", "x") });
+    EXPECT_EQ(alternatives(true)(s4, false), Cbnt::RCode::FAIL);
+    EXPECT_EQ(s4.getPos(), 0u);
+    EXPECT_EQ(Cbnt::cut()(s4, true), Cbnt::RCode::SUCCESS);
+
+    // a failure after the cut that does not throw is still committed
+    State s5({ Token("int", "1"), Token("string", "x") });
+    EXPECT_THROW(
+        Cbnt::choice({
+            Cbnt::seq({
+                baseParser("int"), Cbnt::cut(),
+                Cbnt::ntest(baseParser("string"))
+            }),
+            Cbnt::seq({ baseParser("int"), baseParser("string") })
+        })(s5, false),
+        CutFailure);
+}
+
+#ifndef YAPEG_PROFILE
+TEST(Combinators, named)
+{
+    using Fn = Cbnt::RCode (*)(State&, bool);
+    
+    // without YAPEG_PROFILE a named parser is the parser itself
+    Cbnt::Parser p = Cbnt::named("dummy", dummyParser);
+    ASSERT_NE(p.target<Fn>(), nullptr);
+    EXPECT_EQ(*p.target<Fn>(), &dummyParser);
+}
+#endif
+
 TEST(Combinators, star1)
 {
     State state({
@@ -681,5 +745,581 @@ TEST(Combinators, ntest2)
     EXPECT_EQ(state.getPos(), 0u);
 }
     
-} // close namespace yapeg
+TEST(Combinators, memo1)
+{
+    State state({
+        Token("int", "123"),
+        Token("int", "456"),
+        Token("string", "hello")
+    });
+
+    std::size_t calls = 0;
+    Cbnt::Parser ints =
+        Cbnt::memo(
+            Cbnt::seq({
+                Cbnt::yaction([&calls](State& s) { ++calls; }),
+                Cbnt::plus(baseParser("int"))
+            }));
+    
+    Cbnt::RCode rc =
+        Cbnt::choice({
+            Cbnt::seq({ ints, baseParser("double") }),
+            Cbnt::seq({ ints, baseParser("float") }),
+            Cbnt::seq({
+                ints,
+                Cbnt::yaction(
+                    [](State& s) {
+                        EXPECT_EQ(s.cache().get<Token>(), s.tokens()[1]);
+                    }
+                ),
+                baseParser("string")
+            })
+        })(state, true);
+
+    EXPECT_EQ(rc, Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 3u);
+    EXPECT_EQ(calls, 1u);
+}
+
+TEST(Combinators, memo2)
+{
+    State state({
+        Token("int", "123"),
+        Token("string", "hello")
+    });
+
+    std::size_t calls = 0;
+    Cbnt::Parser floats =
+        Cbnt::memo(
+            Cbnt::seq({
+                baseParser("int"),
+                Cbnt::yaction([&calls](State& s) { ++calls; }),
+                baseParser("float")
+            }));
+
+    Cbnt::RCode rc =
+        Cbnt::seq({ Cbnt::ntest(floats), Cbnt::ntest(floats) })(state, false);
+    EXPECT_EQ(rc, Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 0u);
+    EXPECT_EQ(calls, 1u);
+
+    EXPECT_THROW(floats(state, true), std::runtime_error);
+    EXPECT_EQ(calls, 2u);
+}
+    
+TEST(Combinators, dispatch)
+{
+    State state({
+        Token("int", "1"),
+        Token("string", "hello"),
+        Token("float", "2.0"),
+        Token("int", "3"),
+        Token("double", "6.18")
+    });
+
+    std::vector<std::string> seen;
+    auto tagged =
+        [&seen](const std::string& tag, const std::string& tokenType)
+        {
+            return Cbnt::combo(
+                baseParser(tokenType),
+                [&seen, tag](State& s) { seen.push_back(tag); });
+        };
+    std::function<bool (State&, std::string&)> peek =
+        [](State& s, std::string& key)
+        {
+            if(!s.isValid()) return false;
+            key = s.token().first;
+            return true;
+        };
+    
+    Cbnt::Parser value =
+        Cbnt::dispatch<std::string>(peek, {
+            { {"int"}, Cbnt::seq({ tagged("int+string", "int"),
+                                   baseParser("string") }) },
+            { {"int", "float"}, Cbnt::choice({ tagged("int", "int"),
+                                               tagged("float", "float") }) },
+            { {}, tagged("any", "double") }
+        });
+
+    Cbnt::RCode rc = Cbnt::star(value)(state, true);
+    EXPECT_EQ(rc, Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 5u);
+    EXPECT_EQ(seen,
+              std::vector<std::string>({
+                  "int+string", "float", "int+string", "int", "any" }));
+
+    state.setPos(1);
+    EXPECT_EQ(value(state, false), Cbnt::RCode::FAIL);
+    EXPECT_THROW(value(state, true), std::runtime_error);
+    EXPECT_EQ(state.getPos(), 1u);
+}
+    
+namespace {
+
+Cbnt::Parser intParser()
+{
+    return
+        Cbnt::combo(
+            baseParser("int"),
+            [](State& s) {
+                s.cache().set<int>(std::stoi(s.cache().get<Token>().second));
+            });
+}
+
+Cbnt::Parser subtract(Cbnt::Parser lhsParser)
+{
+    auto lhs = std::make_shared<std::vector<int> >();
+    return
+        Cbnt::seq({
+            lhsParser,
+            Cbnt::yaction(
+                [lhs](State& s) { lhs->push_back(s.cache().get<int>()); }),
+            Cbnt::seq({
+                baseParser("minus"),
+                intParser(),
+                Cbnt::yaction(
+                    [lhs](State& s) {
+                        s.cache().set<int>(lhs->back() - s.cache().get<int>());
+                        lhs->pop_back();
+                    })
+            }),
+        });
+}
+
+} // close anonymous namespace
+    
+TEST(Combinators, memo_left_recursion)
+{
+    State state({
+        Token("int", "10"),
+        Token("minus", "-"),
+        Token("int", "3"),
+        Token("minus", "-"),
+        Token("int", "2"),
+        Token("string", "end")
+    });
+
+    // expr <- expr '-' int / int
+    Cbnt::Parser expr;
+    Cbnt::Parser exprRef =
+        [&expr](State& s, bool must) { return expr(s, must); };
+    expr = Cbnt::memo(Cbnt::choice({ subtract(exprRef), intParser() }));
+
+    Cbnt::RCode rc = Cbnt::seq({ expr, baseParser("string") })(state, true);
+    EXPECT_EQ(rc, Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 6u);
+
+    state.setPos(0);
+    rc = expr(state, true);
+    EXPECT_EQ(rc, Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 5u);
+    EXPECT_EQ(state.cache().get<int>(), 5);
+}
+
+TEST(Combinators, memo_indirect_left_recursion)
+{
+    State state({
+        Token("int", "10"),
+        Token("minus", "-"),
+        Token("int", "3"),
+        Token("minus", "-"),
+        Token("int", "2")
+    });
 
+    // a <- b / int
+    // b <- a '-' int
+    Cbnt::Parser a;
+    Cbnt::Parser b;
+    Cbnt::Parser aRef = [&a](State& s, bool must) { return a(s, must); };
+    Cbnt::Parser bRef = [&b](State& s, bool must) { return b(s, must); };
+    a = Cbnt::memo(Cbnt::choice({ bRef, intParser() }));
+    b = Cbnt::memo(subtract(aRef));
+
+    Cbnt::RCode rc = a(state, true);
+    EXPECT_EQ(rc, Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 5u);
+    EXPECT_EQ(state.cache().get<int>(), 5);
+
+    state.setPos(0);
+    EXPECT_EQ(Cbnt::seq({ b, baseParser("int") })(state, false),
+              Cbnt::RCode::FAIL);
+    EXPECT_EQ(state.getPos(), 0u);
+}
+
+TEST(Combinators, rule)
+{
+    State state({
+        Token("lparen", "("),
+        Token("lparen", "("),
+        Token("rparen", ")"),
+        Token("lparen", "("),
+        Token("rparen", ")"),
+        Token("rparen", ")"),
+        Token("rparen", ")")
+    });
+
+    // nest <- '(' nest* ')'
+    Cbnt::Rule nest;
+    EXPECT_FALSE(nest.isDefined());
+    Cbnt::Parser parser = nest;
+    nest.define(
+        Cbnt::seq({
+            baseParser("lparen"), Cbnt::star(nest), baseParser("rparen")
+        }));
+    EXPECT_TRUE(nest.isDefined());
+
+    EXPECT_EQ(parser(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 6u);
+    state.setPos(1);
+    EXPECT_EQ(nest(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 3u);
+    state.setPos(6);
+    EXPECT_EQ(parser(state, false), Cbnt::RCode::FAIL);
+    EXPECT_EQ(state.getPos(), 6u);
+
+    // copies see a new definition
+    Cbnt::Rule copy(nest);
+    nest.define(baseParser("rparen"));
+    EXPECT_EQ(copy(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 7u);
+
+    nest.reset();
+    EXPECT_FALSE(copy.isDefined());
+    EXPECT_THROW(parser(state, false), std::bad_function_call);
+}
+
+TEST(Combinators, rule_left_recursion)
+{
+    State state({
+        Token("int", "10"),
+        Token("minus", "-"),
+        Token("int", "3"),
+        Token("minus", "-"),
+        Token("int", "2")
+    });
+
+    // expr <- expr '-' int / int
+    Cbnt::Rule expr;
+    expr.define(Cbnt::memo(Cbnt::choice({ subtract(expr), intParser() })));
+
+    EXPECT_EQ(expr(state, true), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 5u);
+    EXPECT_EQ(state.cache().get<int>(), 5);
+    expr.reset();
+}
+
+TEST(Combinators, values)
+{
+    using VCbnt = Combinators<State, std::string>;
+    State state({
+        Token("int", "10"),
+        Token("minus", "-"),
+        Token("int", "3"),
+        Token("minus", "-"),
+        Token("int", "2"),
+        Token("string", "end")
+    });
+
+    auto token =
+        [](const std::string& type) {
+            return VCbnt::push(
+                baseParser(type),
+                [](State& s, std::size_t begin) {
+                    return s.tokens()[begin].second;
+                });
+        };
+    // difference <- int '-' int
+    Cbnt::Parser difference =
+        VCbnt::reduce<3>(
+            VCbnt::seq({ token("int"), token("minus"), token("int") }),
+            [](State&, std::string&& lhs, std::string&& op,
+               std::string&& rhs) {
+                return "(" + lhs + op + rhs + ")";
+            });
+    // the first alternative pushes 10 and 3 before failing
+    Cbnt::Parser parser =
+        VCbnt::seq({
+            Cbnt::choice({
+                VCbnt::seq({ difference, token("string") }),
+                VCbnt::seq({ token("int"), token("minus") })
+            }),
+            VCbnt::ntest(token("minus")),
+            token("int")
+        });
+    EXPECT_EQ(parser(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 3u);
+    EXPECT_EQ(state.values(),
+              std::vector<std::string>({ "10", "-", "3" }));
+
+    state.values().clear();
+    state.setPos(0);
+    Cbnt::Parser list =
+        VCbnt::fold(
+            VCbnt::seq({
+                token("int"),
+                Cbnt::star(VCbnt::seq({ baseParser("minus"), token("int") }))
+            }),
+            [](State&, std::string* first, std::string* last) {
+                std::string all;
+                for(; first != last; ++first) all += *first + ";";
+                return all;
+            });
+    EXPECT_EQ(list(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.values(), std::vector<std::string>({ "10;3;2;" }));
+
+    // a count other than the reduction's is an error
+    state.values().clear();
+    state.setPos(0);
+    EXPECT_THROW(VCbnt::reduce<2>(list, [](State&, std::string&& a,
+                                           std::string&& b) {
+                         return a + b;
+                     })(state, false),
+                 std::logic_error);
+
+    state.values().clear();
+    state.setPos(1);
+    EXPECT_EQ(VCbnt::drop(list)(state, false), Cbnt::RCode::FAIL);
+    EXPECT_EQ(VCbnt::ptest(token("minus"))(state, false),
+              Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 1u);
+    EXPECT_TRUE(state.values().empty());
+}
+
+TEST(Combinators, valuesBacktrack)
+{
+    using VCbnt = Combinators<State, std::string>;
+    State state({
+        Token("int", "10"),
+        Token("minus", "-"),
+        Token("int", "3"),
+        Token("minus", "-"),
+        Token("int", "2"),
+        Token("string", "end")
+    });
+
+    auto token =
+        [](const std::string& type) {
+            return VCbnt::push(
+                baseParser(type),
+                [](State& s, std::size_t begin) {
+                    return s.tokens()[begin].second;
+                });
+        };
+    // a user parser pushing "?" whether it matches or not
+    auto pushy =
+        [](const std::string& type) -> Cbnt::Parser {
+            Cbnt::Parser parser = baseParser(type);
+            return
+                [parser](State& s, bool must) {
+                    s.values().push_back("?");
+                    return parser(s, must);
+                };
+        };
+
+    // failed alternatives and repetitions leave no values behind
+    EXPECT_EQ(VCbnt::choice({ pushy("minus"), token("int") })(state, false),
+              Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.values(), std::vector<std::string>({ "10" }));
+    EXPECT_EQ(VCbnt::qmark(pushy("int"))(state, false),
+              Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(VCbnt::plus(pushy("int"))(state, false), Cbnt::RCode::FAIL);
+    EXPECT_EQ(VCbnt::star(VCbnt::choice({ pushy("minus"), pushy("int") }))(
+                  state, false),
+              Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 5u);
+    EXPECT_EQ(state.values(),
+              std::vector<std::string>({ "10", "?", "?", "?", "?" }));
+
+    // a memo hit pushes the values of the recorded match
+    state.values().clear();
+    state.setPos(0);
+    Cbnt::Parser first = VCbnt::memo(token("int"));
+    EXPECT_EQ(VCbnt::choice({
+                  VCbnt::seq({ first, token("string") }),
+                  VCbnt::seq({ first, token("minus") })
+              })(state, false),
+              Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.values(), std::vector<std::string>({ "10", "-" }));
+
+    // and so does a grown left-recursive rule
+    // expr <- expr '-' int / int
+    state.values().clear();
+    state.setPos(0);
+    Cbnt::Rule expr;
+    expr.define(
+        VCbnt::memo(
+            VCbnt::choice({
+                VCbnt::reduce<3>(
+                    VCbnt::seq({ expr, token("minus"), token("int") }),
+                    [](State&, std::string&& lhs, std::string&& op,
+                       std::string&& rhs) {
+                        return "(" + lhs + op + rhs + ")";
+                    }),
+                token("int")
+            })));
+    EXPECT_EQ(expr(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 5u);
+    EXPECT_EQ(state.values(), std::vector<std::string>({ "((10-3)-2)" }));
+    expr.reset();
+}
+
+TEST(Combinators, valuesOperators)
+{
+    using VCbnt = Combinators<State, std::string>;
+    State state({
+        Token("int", "10"),
+        Token("minus", "-"),
+        Token("int", "3"),
+        Token("times", "*"),
+        Token("int", "2"),
+        Token("minus", "-"),
+        Token("string", "end")
+    });
+
+    auto token =
+        [](const std::string& type) {
+            return VCbnt::push(
+                baseParser(type),
+                [](State& s, std::size_t begin) {
+                    return s.tokens()[begin].second;
+                });
+        };
+    auto combine =
+        [](State&, std::string&& lhs, std::string&& op, std::string&& rhs) {
+            return "(" + lhs + op + rhs + ")";
+        };
+    Cbnt::Parser expr =
+        VCbnt::operators(
+            token("int"),
+            {
+                { token("minus"), 1, VCbnt::Assoc::LEFT },
+                { token("times"), 2, VCbnt::Assoc::LEFT }
+            },
+            combine);
+
+    // the trailing operator is left unconsumed, with its value dropped
+    EXPECT_EQ(expr(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 5u);
+    EXPECT_EQ(state.values(), std::vector<std::string>({ "(10-(3*2))" }));
+
+    // an operand must push one value
+    state.values().clear();
+    state.setPos(0);
+    EXPECT_THROW(VCbnt::operators(baseParser("int"),
+                                  { { token("minus"), 1,
+                                      VCbnt::Assoc::LEFT } },
+                                  combine)(state, false),
+                 std::logic_error);
+}
+
+TEST(Combinators, captureMove)
+{
+    State state({ Token("int", "1"), Token("int", "2") });
+
+    std::vector<std::string> words;
+    std::vector<std::string> taken;
+    const std::string* data = 0;
+    Cbnt::Parser parser =
+        [&](State& s, bool must) {
+            std::vector<std::string> ans(2, s.token().second);
+            data = ans.data();
+            return Cbnt::invoke(baseParser("int"), s, must, std::move(ans));
+        };
+    EXPECT_EQ(Cbnt::combo(parser,
+                          Cbnt::captureMove<std::vector<std::string> >(
+                              taken))(state, false),
+              Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(taken, std::vector<std::string>({ "1", "1" }));
+    EXPECT_EQ(taken.data(), data);
+    EXPECT_TRUE(state.cache().isNone());
+
+    // lvalues are copied
+    words.push_back("w");
+    EXPECT_EQ(Cbnt::invoke(baseParser("int"), state, false, words),
+              Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(words.size(), 1u);
+    EXPECT_EQ(state.cache().get<std::vector<std::string> >(), words);
+}
+
+TEST(Combinators, operators)
+{
+    using Op = Cbnt::Operator;
+    Cbnt::Parser expr =
+        Cbnt::operators(
+            intParser(),
+            {
+                Op{ baseParser("plus"), 1, Cbnt::Assoc::LEFT },
+                Op{ baseParser("minus"), 1, Cbnt::Assoc::LEFT },
+                Op{ baseParser("times"), 2, Cbnt::Assoc::LEFT },
+                Op{ baseParser("pow"), 3, Cbnt::Assoc::RIGHT }
+            },
+            [](State& s, const Any& lhs, const Any& op, const Any& rhs) {
+                int l = lhs.get<int>();
+                int r = rhs.get<int>();
+                const std::string& name = op.get<Token>().first;
+                int v =
+                    name == "plus" ? l + r :
+                    name == "minus" ? l - r :
+                    name == "times" ? l * r :
+                    static_cast<int>(std::pow(l, r));
+                s.cache().set(v);
+            });
+
+    State state1({
+        Token("int", "2"), Token("minus", "-"), Token("int", "3"),
+        Token("minus", "-"), Token("int", "1")
+    });
+    EXPECT_EQ(expr(state1, true), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state1.getPos(), 5u);
+    EXPECT_EQ(state1.cache().get<int>(), -2);
+    
+    State state2({
+        Token("int", "2"), Token("pow", "^"), Token("int", "3"),
+        Token("pow", "^"), Token("int", "2")
+    });
+    EXPECT_EQ(expr(state2, true), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state2.cache().get<int>(), 512);
+
+    State state3({
+        Token("int", "1"), Token("plus", "+"), Token("int", "2"),
+        Token("times", "*"), Token("int", "3"), Token("pow", "^"),
+        Token("int", "2"), Token("minus", "-"), Token("int", "4"),
+        Token("times", "*"), Token("string", "x")
+    });
+    EXPECT_EQ(expr(state3, true), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state3.getPos(), 9u);
+    EXPECT_EQ(state3.cache().get<int>(), 15);
+
+    State state4({ Token("plus", "+") });
+    EXPECT_EQ(expr(state4, false), Cbnt::RCode::FAIL);
+    EXPECT_EQ(state4.getPos(), 0u);
+}
+
+TEST(Combinators, operatorsNegativePrecedence)
+{
+    using Op = Cbnt::Operator;
+    Cbnt::Parser expr =
+        Cbnt::operators(
+            intParser(),
+            {
+                Op{ baseParser("minus"), -1, Cbnt::Assoc::LEFT },
+                Op{ baseParser("times"), 0, Cbnt::Assoc::LEFT }
+            },
+            [](State& s, const Any& lhs, const Any& op, const Any& rhs) {
+                int l = lhs.get<int>();
+                int r = rhs.get<int>();
+                s.cache().set(op.get<Token>().first == "minus" ? l - r
+                                                               : l * r);
+            });
+
+    State state({
+        Token("int", "2"), Token("minus", "-"), Token("int", "3"),
+        Token("times", "*"), Token("int", "2")
+    });
+    EXPECT_EQ(expr(state, true), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 5u);
+    EXPECT_EQ(state.cache().get<int>(), -4);
+}
+    
+} // close namespace yapeg
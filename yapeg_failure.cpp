@@ -0,0 +1,34 @@
+#include <yapeg_failure.h>
+#include <algorithm>
+
+namespace yapeg {
+
+// ACCESSORS
+std::vector<std::string> FarthestFailure::expected() const
+{
+    std::vector<std::string> result;
+    for(auto it = d_expected.begin(); it != d_expected.end(); ++it)
+    {
+        result.push_back(**it);
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::string FarthestFailure::message() const
+{
+    std::vector<std::string> items = expected();
+    std::string text = "expected ";
+    for(std::size_t i = 0; i < items.size(); ++i)
+    {
+        if(i)
+        {
+            text += i + 1 == items.size() ? " or " : ", ";
+        }
+        text += items[i];
+    }
+    return text + " at " + std::to_string(d_pos);
+}
+
+} // close namespace yapeg
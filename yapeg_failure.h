@@ -0,0 +1,95 @@
+#ifndef INCLUDED_YAPEG_FAILURE_H
+#define INCLUDED_YAPEG_FAILURE_H
+
+#include <yapeg_combinators.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+// Farthest position at which a leaf parser failed, with what the
+// failing leaves expected there.  Recording costs nothing on success and
+// a comparison on most failures.  The expectations are kept as pointers
+// to strings owned by the parsers, so the grammar must outlive the
+// recorded failure until it is read.
+class FarthestFailure
+{
+private:
+    // DATA
+    std::size_t d_pos;
+    std::vector<const std::string*> d_expected;
+
+public:
+    // CREATORS
+    FarthestFailure(): d_pos(0) {}
+
+    // MANIPULATORS
+    void record(std::size_t pos, const std::string& expected)
+    {
+        if(pos < d_pos) return;
+        if(pos > d_pos)
+        {
+            d_pos = pos;
+            d_expected.clear();
+        }
+        d_expected.push_back(&expected);
+    }
+
+    void clear()
+    {
+        d_pos = 0;
+        d_expected.clear();
+    }
+
+    // ACCESSORS
+    bool empty() const
+    {
+        return d_expected.empty();
+    }
+
+    std::size_t pos() const
+    {
+        return d_pos;
+    }
+
+    // Return the sorted distinct expectations at pos().
+    std::vector<std::string> expected() const;
+
+    // Return "expected a, b or c at pos".
+    std::string message() const;
+};
+
+// Run 'parser' on 'state' with the failures of Scanners leaves recorded
+// in 'failure' instead of thrown, whatever 'must' they get.  Return true
+// on success; otherwise 'failure' describes the farthest failure.  A
+// failure after a cut still commits the parse: seq throws CutFailure, so
+// no enclosing choice tries another alternative, and false is returned.
+// class State must have 'void trackFailures(FarthestFailure*)'.
+template<typename Parser, typename State>
+bool parseTracked(const Parser& parser,
+                  State& state,
+                  FarthestFailure& failure)
+{
+    struct Guard
+    {
+        State& d_state;
+        ~Guard() { d_state.trackFailures(nullptr); }
+    } guard{state};
+
+    using RCode = typename Combinators<State>::RCode;
+    failure.clear();
+    state.trackFailures(&failure);
+    try
+    {
+        return RCode::SUCCESS == parser(state, false);
+    }
+    catch(const CutFailure&)
+    {
+        return false;
+    }
+}
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_FAILURE_H
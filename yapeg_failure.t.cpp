@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <yapeg_failure.h>
+#include <yapeg_scanners.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using Scn = Scanners<BufferState>;
+
+} // close anonymous namespace
+
+TEST(FarthestFailure, record)
+{
+    std::string a("'a'"), b("'b'"), c("'c'");
+    FarthestFailure failure;
+    EXPECT_TRUE(failure.empty());
+
+    failure.record(2, c);
+    failure.record(3, b);
+    failure.record(1, c);
+    failure.record(3, a);
+    failure.record(3, b);
+    EXPECT_FALSE(failure.empty());
+    EXPECT_EQ(failure.pos(), 3u);
+    EXPECT_EQ(failure.expected(), std::vector<std::string>({ a, b }));
+    EXPECT_EQ(failure.message(), "expected 'a' or 'b' at 3");
+
+    failure.clear();
+    EXPECT_TRUE(failure.empty());
+    EXPECT_EQ(failure.pos(), 0u);
+}
+
+TEST(FarthestFailure, parseTracked)
+{
+    Cbnt::Parser value =
+        Cbnt::choice({
+            Scn::plus(Scn::range('0', '9')),
+            Scn::literal("true"),
+            Scn::literal("false")
+        });
+    Cbnt::Parser grammar =
+        Cbnt::seq({
+            Scn::literal("x"),
+            Cbnt::cut(),
+            Scn::ch('='),
+            value,
+            Scn::ch(';')
+        });
+
+    FarthestFailure failure;
+    std::string good("x=true;");
+    BufferState s1(good);
+    EXPECT_TRUE(parseTracked(grammar, s1, failure));
+    EXPECT_EQ(s1.getPos(), good.size());
+    EXPECT_EQ(s1.failures(), nullptr);
+
+    std::string bad("x=maybe;");
+    BufferState s2(bad);
+    EXPECT_FALSE(parseTracked(grammar, s2, failure));
+    EXPECT_EQ(failure.pos(), 2u);
+    EXPECT_EQ(failure.message(),
+              "expected \"false\", \"true\" or [0-9] at 2");
+
+    // the same grammar throws when no failures are tracked
+    s2.setPos(0);
+    EXPECT_THROW(grammar(s2, false), ScanError);
+}
+
+TEST(FarthestFailure, parseTrackedCut)
+{
+    // a failure after the cut ends the parse instead of trying 'b'
+    Cbnt::Parser grammar =
+        Cbnt::choice({
+            Cbnt::seq({ Scn::ch('a'), Cbnt::cut(), Scn::ch('c') }),
+            Scn::ch('b')
+        });
+
+    FarthestFailure failure;
+    std::string text("ab");
+    BufferState state(text);
+    EXPECT_FALSE(parseTracked(grammar, state, failure));
+    EXPECT_EQ(failure.pos(), 1u);
+    EXPECT_EQ(failure.message(), "expected 'c' at 1");
+    EXPECT_EQ(state.failures(), nullptr);
+
+    state.setPos(0);
+    EXPECT_THROW(grammar(state, false), ScanError);
+}
+
+} // close namespace yapeg
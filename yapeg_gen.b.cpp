@@ -0,0 +1,123 @@
+#include <yapeg_bench.h>
+#include <yapeg_gen_expr.h>
+#include <yapeg_scanners.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <cassert>
+#include <memory>
+#include <string>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using Scn = Scanners<BufferState>;
+
+struct NoActors
+{
+    void mark(BufferState&) {}
+    void number(BufferState&) {}
+    void variable(BufferState&) {}
+    void add(BufferState&) {}
+    void sub(BufferState&) {}
+    void mul(BufferState&) {}
+    void div(BufferState&) {}
+    void mod(BufferState&) {}
+};
+
+std::string exprInput()
+{
+    std::string text;
+    for(int i = 0; i < 5000; ++i)
+    {
+        text += "(12 + x" + std::to_string(i) + ") * 7 mod 5 - ";
+    }
+    return text + "1\n";
+}
+
+// yapeg_gen_expr.peg written with combinators, without actions.
+Cbnt::Parser exprGrammar()
+{
+    auto sum = std::make_shared<Cbnt::Parser>();
+    Cbnt::Parser sumRef =
+        [sum](BufferState& state, bool must) { return (*sum)(state, must); };
+    CharClass identHead('a', 'z');
+    identHead.add('A', 'Z').add('_').add('$');
+    CharClass identTail(identHead);
+    identTail.add('0', '9');
+
+    Cbnt::Parser spacing =
+        Cbnt::star(
+            Cbnt::choice({
+                Scn::charset(" \t\r\n"),
+                Cbnt::seq({ Scn::ch('#'), Scn::star(Scn::charset(
+                                CharClass('\n', '\n').negate())) })
+            }));
+    auto token = [spacing](Cbnt::Parser parser) {
+        return Cbnt::seq({ parser, spacing });
+    };
+    Cbnt::Parser value =
+        Cbnt::choice({
+            token(Scn::plus(Scn::range('0', '9'))),
+            token(Cbnt::seq({ Scn::charset(identHead),
+                              Scn::star(Scn::charset(identTail)) })),
+            Cbnt::seq({ token(Scn::ch('(')), sumRef, token(Scn::ch(')')) })
+        });
+    Cbnt::Parser product =
+        Cbnt::seq({
+            value,
+            Cbnt::star(Cbnt::seq({
+                Cbnt::choice({
+                    token(Scn::ch('*')),
+                    token(Scn::ch('/')),
+                    token(Cbnt::seq({
+                        Scn::literal("mod"),
+                        Cbnt::ntest(Scn::charset(identTail))
+                    }))
+                }),
+                value
+            }))
+        });
+    *sum =
+        Cbnt::seq({
+            product,
+            Cbnt::star(Cbnt::seq({
+                Cbnt::choice({ token(Scn::ch('+')), token(Scn::ch('-')) }),
+                product
+            }))
+        });
+    return Cbnt::seq({ spacing, sumRef, Cbnt::ntest(Scn::any()) });
+}
+
+void benchExprCombinators(bench::Counters& counters)
+{
+    static const std::string input = exprInput();
+    static const Cbnt::Parser grammar = exprGrammar();
+
+    BufferState state(input);
+    grammar(state, false);
+    assert(state.getPos() == input.size());
+    counters.d_bytes += input.size();
+    counters.d_items += 5000;
+}
+bench::Registrar s_exprCombinators("gen/expr_combinators",
+                                   &benchExprCombinators);
+
+void benchExprGenerated(bench::Counters& counters)
+{
+    static const std::string input = exprInput();
+    static NoActors actors;
+    static const ExprParser<BufferState, NoActors> parser(actors);
+
+    BufferState state(input);
+    parser.parse(state);
+    assert(state.getPos() == input.size());
+    counters.d_bytes += input.size();
+    counters.d_items += 5000;
+}
+bench::Registrar s_exprGenerated("gen/expr_generated", &benchExprGenerated);
+
+} // close anonymous namespace
+
+} // close namespace yapeg
@@ -0,0 +1,1173 @@
+#include <yapeg_gen.h>
+#include <bitset>
+#include <cctype>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace yapeg {
+
+namespace {
+
+// Recursive-descent reader of the grammar text.
+class PegReader
+{
+private:
+    // DATA
+    const std::string& d_text;
+    std::size_t d_pos;
+
+    // ACCESSORS
+    bool atEnd() const { return d_pos >= d_text.size(); }
+    char peek() const { return atEnd() ? '\0' : d_text[d_pos]; }
+
+    bool startsWith(const char* str) const
+    {
+        return 0 == d_text.compare(d_pos, std::string(str).size(), str);
+    }
+
+    bool atIdentifier() const
+    {
+        return !atEnd() && (std::isalpha(static_cast<unsigned char>(peek()))
+                            || '_' == peek());
+    }
+
+    // Return true if an identifier followed by '<-' starts here.
+    bool atDefinition() const
+    {
+        std::size_t pos = d_pos;
+        while(pos < d_text.size() &&
+              (std::isalnum(static_cast<unsigned char>(d_text[pos])) ||
+               '_' == d_text[pos]))
+        {
+            ++pos;
+        }
+        PegReader ahead(d_text, pos);
+        ahead.skipSpacing();
+        return ahead.startsWith("<-");
+    }
+
+    std::invalid_argument error(const std::string& message) const
+    {
+        std::size_t line = 1;
+        for(std::size_t i = 0; i < d_pos && i < d_text.size(); ++i)
+        {
+            if('\n' == d_text[i]) ++line;
+        }
+        std::ostringstream out;
+        out << "line " << line << ": " << message;
+        return std::invalid_argument(out.str());
+    }
+
+    // MANIPULATORS
+    void skipSpacing()
+    {
+        while(!atEnd())
+        {
+            if(std::isspace(static_cast<unsigned char>(peek())))
+            {
+                ++d_pos;
+            }
+            else if('#' == peek())
+            {
+                while(!atEnd() && '\n' != peek()) ++d_pos;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+
+    bool accept(const char* token)
+    {
+        if(!startsWith(token)) return false;
+        d_pos += std::string(token).size();
+        skipSpacing();
+        return true;
+    }
+
+    void expect(const char* token)
+    {
+        if(!accept(token))
+        {
+            throw error(std::string("expected '") + token + "'");
+        }
+    }
+
+    std::string identifier()
+    {
+        if(!atIdentifier())
+        {
+            throw error("expected an identifier");
+        }
+        std::size_t begin = d_pos;
+        while(!atEnd() && (std::isalnum(static_cast<unsigned char>(peek()))
+                           || '_' == peek()))
+        {
+            ++d_pos;
+        }
+        std::string name = d_text.substr(begin, d_pos - begin);
+        skipSpacing();
+        return name;
+    }
+
+    char escaped()
+    {
+        if(atEnd()) throw error("unterminated escape");
+        char c = d_text[d_pos++];
+        switch(c)
+        {
+        case 'n': return '\n';
+        case 'r': return '\r';
+        case 't': return '\t';
+        case '\\': case '\'': case '"': case '[': case ']': case '-':
+            return c;
+        case 'x':
+            if(d_pos + 2 <= d_text.size() &&
+               std::isxdigit(static_cast<unsigned char>(d_text[d_pos])) &&
+               std::isxdigit(static_cast<unsigned char>(d_text[d_pos + 1])))
+            {
+                c = static_cast<char>(
+                    std::stoi(d_text.substr(d_pos, 2), nullptr, 16));
+                d_pos += 2;
+                return c;
+            }
+            throw error("expected two hex digits after \\x");
+        }
+        --d_pos;
+        throw error(std::string("unknown escape \\") + c);
+    }
+
+    // Read one possibly escaped character of a literal or class.
+    char character()
+    {
+        char c = d_text[d_pos++];
+        return '\\' == c ? escaped() : c;
+    }
+
+    Pattern literal()
+    {
+        char quote = d_text[d_pos++];
+        std::string str;
+        while(!atEnd() && quote != peek())
+        {
+            str += character();
+        }
+        if(atEnd()) throw error("unterminated literal");
+        ++d_pos;
+        skipSpacing();
+        return 1 == str.size() ? Pattern::ch(str[0]) : Pattern::literal(str);
+    }
+
+    Pattern charClass()
+    {
+        ++d_pos;
+        bool negated = '^' == peek();
+        if(negated) ++d_pos;
+        CharClass cls;
+        while(!atEnd() && ']' != peek())
+        {
+            char lo = character();
+            if('-' == peek() && d_pos + 1 < d_text.size() &&
+               ']' != d_text[d_pos + 1])
+            {
+                ++d_pos;
+                char hi = character();
+                if(static_cast<unsigned char>(hi) <
+                   static_cast<unsigned char>(lo))
+                {
+                    throw error("reversed range in class");
+                }
+                cls.add(lo, hi);
+            }
+            else
+            {
+                cls.add(lo);
+            }
+        }
+        if(atEnd()) throw error("unterminated class");
+        ++d_pos;
+        skipSpacing();
+        if(negated) cls.negate();
+        return Pattern::charset(cls);
+    }
+
+    Pattern primary()
+    {
+        if(atIdentifier() && !atDefinition())
+        {
+            return Pattern::rule(identifier());
+        }
+        if(accept("("))
+        {
+            Pattern pattern = expression();
+            expect(")");
+            return pattern;
+        }
+        if('\'' == peek() || '"' == peek())
+        {
+            return literal();
+        }
+        if('[' == peek())
+        {
+            return charClass();
+        }
+        if(accept("."))
+        {
+            return Pattern::any();
+        }
+        if(accept("{"))
+        {
+            std::string name = identifier();
+            expect("}");
+            return Pattern::action(name);
+        }
+        throw error("expected an expression");
+    }
+
+    Pattern suffix()
+    {
+        Pattern pattern = primary();
+        if(accept("*")) return Pattern::star(pattern);
+        if(accept("+")) return Pattern::plus(pattern);
+        if(accept("?")) return Pattern::qmark(pattern);
+        return pattern;
+    }
+
+    Pattern prefix()
+    {
+        if(accept("&")) return Pattern::ptest(suffix());
+        if(accept("!")) return Pattern::ntest(suffix());
+        return suffix();
+    }
+
+    bool atPrefix() const
+    {
+        char c = peek();
+        return (atIdentifier() && !atDefinition()) ||
+            '(' == c || '\'' == c || '"' == c || '[' == c || '.' == c ||
+            '{' == c || '&' == c || '!' == c;
+    }
+
+    Pattern sequence()
+    {
+        std::vector<Pattern> patterns;
+        while(!atEnd() && atPrefix())
+        {
+            patterns.push_back(prefix());
+        }
+        if(patterns.empty()) return Pattern::literal("");
+        return 1 == patterns.size() ? patterns[0] : Pattern::seq(patterns);
+    }
+
+    Pattern expression()
+    {
+        std::vector<Pattern> patterns(1, sequence());
+        while(accept("/"))
+        {
+            patterns.push_back(sequence());
+        }
+        return 1 == patterns.size() ? patterns[0] : Pattern::choice(patterns);
+    }
+
+public:
+    // CREATORS
+    PegReader(const std::string& text, std::size_t pos = 0)
+        : d_text(text)
+        , d_pos(pos) {}
+
+    // MANIPULATORS
+    PegGrammar grammar()
+    {
+        PegGrammar result;
+        std::set<std::string> names;
+        skipSpacing();
+        while(!atEnd())
+        {
+            std::string name = identifier();
+            if(!names.insert(name).second)
+            {
+                throw error("rule " + name + " defined twice");
+            }
+            expect("<-");
+            result.d_rules.push_back(std::make_pair(name, expression()));
+        }
+        if(result.d_rules.empty())
+        {
+            throw error("no rules");
+        }
+        return result;
+    }
+};
+
+// What a pattern may start with: d_nullable if it may succeed without
+// consuming (or only tests ahead), else only on a character of d_chars.
+struct First
+{
+    std::bitset<256> d_chars;
+    bool d_nullable;
+
+    bool operator== (const First& other) const
+    {
+        return d_chars == other.d_chars && d_nullable == other.d_nullable;
+    }
+};
+
+std::string charLiteral(int c)
+{
+    if('\t' == c) return "'\\t'";
+    if('\n' == c) return "'\\n'";
+    if('\r' == c) return "'\\r'";
+    if('\\' == c) return "'\\\\'";
+    if('\'' == c) return "'\\''";
+    if(c >= 0x20 && c < 0x7f) return std::string("'") + char(c) + "'";
+    return std::to_string(c);
+}
+
+std::string stringLiteral(const std::string& str)
+{
+    std::string result("\"");
+    for(std::size_t i = 0; i < str.size(); ++i)
+    {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        if('"' == c || '\\' == c || '?' == c)
+        {
+            result += '\\';
+            result += char(c);
+        }
+        else if(c >= 0x20 && c < 0x7f)
+        {
+            result += char(c);
+        }
+        else
+        {
+            char octal[8];
+            std::snprintf(octal, sizeof(octal), "\\%03o", c);
+            result += octal;
+        }
+    }
+    return result + "\"";
+}
+
+class Generator
+{
+private:
+    // DATA
+    const PegGrammar& d_grammar;
+    std::map<std::string, const Pattern*> d_rules;
+    std::map<std::string, First> d_firsts;
+    std::map<const Pattern::Node*, std::string> d_defined;
+    std::vector<std::string> d_expected;
+    std::map<std::string, std::size_t> d_expectedIds;
+    std::set<std::string> d_actions;
+    std::ostringstream d_helpers;    // private static functions
+    std::ostringstream d_functions;  // private node functions
+    std::map<std::string, std::string> d_sets;  // class tests by class
+
+    // ACCESSORS
+    First first(const Pattern& pattern) const
+    {
+        const Pattern::Node& node = pattern.node();
+        First result;
+        result.d_nullable = false;
+        switch(node.d_kind)
+        {
+        case Pattern::Kind::CLASS:
+            for(int c = 0; c < 256; ++c)
+            {
+                result.d_chars[c] = node.d_class.test(static_cast<char>(c));
+            }
+            break;
+        case Pattern::Kind::ANY:
+            result.d_chars.set();
+            break;
+        case Pattern::Kind::LITERAL:
+            if(node.d_text.empty())
+            {
+                result.d_nullable = true;
+            }
+            else
+            {
+                result.d_chars[static_cast<unsigned char>(node.d_text[0])] =
+                    true;
+            }
+            break;
+        case Pattern::Kind::SEQ:
+            result.d_nullable = true;
+            for(auto it = node.d_children.begin();
+                it != node.d_children.end(); ++it)
+            {
+                First child = first(*it);
+                result.d_chars |= child.d_chars;
+                if(!child.d_nullable)
+                {
+                    result.d_nullable = false;
+                    break;
+                }
+            }
+            break;
+        case Pattern::Kind::CHOICE:
+            for(auto it = node.d_children.begin();
+                it != node.d_children.end(); ++it)
+            {
+                First child = first(*it);
+                result.d_chars |= child.d_chars;
+                result.d_nullable = result.d_nullable || child.d_nullable;
+            }
+            break;
+        case Pattern::Kind::STAR:
+        case Pattern::Kind::QMARK:
+            result = first(node.d_children[0]);
+            result.d_nullable = true;
+            break;
+        case Pattern::Kind::PLUS:
+            result = first(node.d_children[0]);
+            break;
+        case Pattern::Kind::PTEST:
+        case Pattern::Kind::NTEST:
+        case Pattern::Kind::ACTION:
+            // succeed without consuming; a following sequence element
+            // decides the first character
+            result.d_nullable = true;
+            break;
+        case Pattern::Kind::RULE:
+            result = d_firsts.find(node.d_text)->second;
+            break;
+        }
+        return result;
+    }
+
+    static bool alwaysSucceeds(const Pattern& pattern)
+    {
+        const Pattern::Node& node = pattern.node();
+        switch(node.d_kind)
+        {
+        case Pattern::Kind::STAR:
+        case Pattern::Kind::QMARK:
+        case Pattern::Kind::ACTION:
+            return true;
+        case Pattern::Kind::LITERAL:
+            return node.d_text.empty();
+        default:
+            return false;
+        }
+    }
+
+    // MANIPULATORS
+    void check(const Pattern& pattern)
+    {
+        const Pattern::Node& node = pattern.node();
+        if(Pattern::Kind::RULE == node.d_kind &&
+           !d_rules.count(node.d_text))
+        {
+            throw std::invalid_argument("missing rule " + node.d_text);
+        }
+        if(Pattern::Kind::ACTION == node.d_kind)
+        {
+            d_actions.insert(node.d_text);
+        }
+        for(auto it = node.d_children.begin();
+            it != node.d_children.end(); ++it)
+        {
+            check(*it);
+        }
+    }
+
+    // Compute the First of every rule as the least fixed point.
+    void computeFirsts()
+    {
+        for(auto it = d_rules.begin(); it != d_rules.end(); ++it)
+        {
+            d_firsts[it->first] = First{ std::bitset<256>(), false };
+        }
+        bool changed = true;
+        while(changed)
+        {
+            changed = false;
+            for(auto it = d_rules.begin(); it != d_rules.end(); ++it)
+            {
+                First updated = first(*it->second);
+                if(!(updated == d_firsts[it->first]))
+                {
+                    d_firsts[it->first] = updated;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Throw std::invalid_argument if a star or plus of rule 'name' may
+    // repeat a match of nothing forever.
+    void checkLoops(const std::string& name, const Pattern& pattern) const
+    {
+        const Pattern::Node& node = pattern.node();
+        if((Pattern::Kind::STAR == node.d_kind ||
+            Pattern::Kind::PLUS == node.d_kind) &&
+           first(node.d_children[0]).d_nullable)
+        {
+            throw std::invalid_argument(
+                "rule " + name + " repeats an expression matching nothing");
+        }
+        for(auto it = node.d_children.begin();
+            it != node.d_children.end(); ++it)
+        {
+            checkLoops(name, *it);
+        }
+    }
+
+    // Add to 'calls' the rules 'pattern' may call before consuming.
+    void leftCalls(const Pattern& pattern,
+                   std::set<std::string>& calls) const
+    {
+        const Pattern::Node& node = pattern.node();
+        if(Pattern::Kind::RULE == node.d_kind)
+        {
+            calls.insert(node.d_text);
+        }
+        for(auto it = node.d_children.begin();
+            it != node.d_children.end(); ++it)
+        {
+            leftCalls(*it, calls);
+            if(Pattern::Kind::SEQ == node.d_kind && !first(*it).d_nullable)
+            {
+                break;
+            }
+        }
+    }
+
+    // Return true if rule 'from' calls rule 'name' before consuming,
+    // directly or through the rules in 'visited'.
+    bool reaches(const std::string& from,
+                 const std::string& name,
+                 std::set<std::string>& visited) const
+    {
+        std::set<std::string> calls;
+        leftCalls(*d_rules.find(from)->second, calls);
+        for(auto it = calls.begin(); it != calls.end(); ++it)
+        {
+            if(*it == name) return true;
+            if(visited.insert(*it).second && reaches(*it, name, visited))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Throw std::invalid_argument on a left-recursive rule or a loop
+    // over an expression matching nothing, which would never end.
+    void checkTermination() const
+    {
+        for(auto it = d_grammar.d_rules.begin();
+            it != d_grammar.d_rules.end(); ++it)
+        {
+            std::set<std::string> visited;
+            if(reaches(it->first, it->first, visited))
+            {
+                throw std::invalid_argument(
+                    "rule " + it->first + " is left-recursive");
+            }
+            checkLoops(it->first, it->second);
+        }
+    }
+
+    std::size_t expected(const std::string& str)
+    {
+        auto it = d_expectedIds.find(str);
+        if(it != d_expectedIds.end()) return it->second;
+        d_expected.push_back(str);
+        return d_expectedIds[str] = d_expected.size() - 1;
+    }
+
+    // Return a C++ condition on 'unsigned char c' testing 'cls'.  A class
+    // of more than two ranges is tested by a helper function.
+    std::string condition(const CharClass& cls)
+    {
+        std::vector<std::pair<int, int> > ranges;
+        for(int c = 0; c < 256; ++c)
+        {
+            if(!cls.test(static_cast<char>(c))) continue;
+            if(!ranges.empty() && ranges.back().second == c - 1)
+            {
+                ranges.back().second = c;
+            }
+            else
+            {
+                ranges.push_back(std::make_pair(c, c));
+            }
+        }
+        if(ranges.empty()) return "false";
+        if(1 == ranges.size() && 0 == ranges[0].first &&
+           255 == ranges[0].second)
+        {
+            return "true";
+        }
+        if(ranges.size() <= 2)
+        {
+            std::string result = rangeTest(ranges[0], ranges.size() > 1);
+            if(ranges.size() > 1)
+            {
+                result += " || " + rangeTest(ranges[1], true);
+            }
+            return result;
+        }
+
+        std::string key = cls.describe();
+        auto found = d_sets.find(key);
+        if(found != d_sets.end()) return found->second + "(c)";
+        std::string name = "inSet" + std::to_string(d_sets.size());
+        d_sets[key] = name;
+        d_helpers << "    static bool " << name << "(unsigned char c)\n"
+                  << "    {\n";
+        if(ranges.size() <= 4)
+        {
+            d_helpers << "        return";
+            for(std::size_t i = 0; i < ranges.size(); ++i)
+            {
+                d_helpers << (i ? " ||\n            " : " ")
+                          << rangeTest(ranges[i], true);
+            }
+            d_helpers << ";\n";
+        }
+        else
+        {
+            d_helpers << "        static const unsigned char k_BITS[32] = {";
+            for(int i = 0; i < 32; ++i)
+            {
+                int byte = 0;
+                for(int bit = 0; bit < 8; ++bit)
+                {
+                    if(cls.test(static_cast<char>(i * 8 + bit)))
+                    {
+                        byte |= 1 << bit;
+                    }
+                }
+                d_helpers << (i % 8 ? " " : "\n            ") << byte
+                          << (i < 31 ? "," : "");
+            }
+            d_helpers << "\n        };\n"
+                      << "        return (k_BITS[c >> 3] >> (c & 7)) & 1;\n";
+        }
+        d_helpers << "    }\n\n";
+        return name + "(c)";
+    }
+
+    // Return 'test' ready to be negated.
+    static std::string negatable(const std::string& test)
+    {
+        return std::string::npos == test.find(' ') ? test : "(" + test + ")";
+    }
+
+    // Return a test of 'c' in 'range', parenthesized if 'nested' and
+    // needed.
+    static std::string rangeTest(const std::pair<int, int>& range,
+                                 bool nested)
+    {
+        int lo = range.first;
+        int hi = range.second;
+        if(lo == hi) return "c == " + charLiteral(lo);
+        if(0 == lo) return "c <= " + charLiteral(hi);
+        if(255 == hi) return "c >= " + charLiteral(lo);
+        std::string test =
+            "c >= " + charLiteral(lo) + " && c <= " + charLiteral(hi);
+        return nested ? "(" + test + ")" : test;
+    }
+
+    // Return a call of the parser of 'pattern' with 'must'.
+    std::string call(const Pattern& pattern, const std::string& must)
+    {
+        const Pattern::Node& node = pattern.node();
+        std::string name = Pattern::Kind::RULE == node.d_kind ?
+            "rule_" + node.d_text : define(pattern);
+        return name + "(state, " + must + ")";
+    }
+
+    // Emit the function parsing 'pattern' unless it exists; return its
+    // name.
+    std::string define(const Pattern& pattern)
+    {
+        const Pattern::Node& node = pattern.node();
+        auto found = d_defined.find(&node);
+        if(found != d_defined.end()) return found->second;
+        std::string name = "e" + std::to_string(d_defined.size());
+        d_defined[&node] = name;
+
+        std::ostringstream body;
+        const std::vector<Pattern>& children = node.d_children;
+        switch(node.d_kind)
+        {
+        case Pattern::Kind::CLASS:
+        case Pattern::Kind::ANY:
+        {
+            std::string test;
+            std::size_t id;
+            if(Pattern::Kind::ANY == node.d_kind)
+            {
+                test = "true";
+                id = expected("any character");
+            }
+            else
+            {
+                test = condition(node.d_class);
+                id = expected(node.d_text.empty() ?
+                              node.d_class.describe() :
+                              "'" + node.d_text + "'");
+            }
+            body << "        if(state.fetch(1))\n"
+                 << "        {\n"
+                 << "            unsigned char c = static_cast<unsigned "
+                 << "char>(*state.current());\n"
+                 << "            if(" << test << ")\n"
+                 << "            {\n"
+                 << "                state.cache().set(*state.current());\n"
+                 << "                state.advance(1);\n"
+                 << "                return RCode::SUCCESS;\n"
+                 << "            }\n"
+                 << "        }\n"
+                 << "        return Scanners::fail(state, must, expected("
+                 << id << "));\n";
+            if("true" == test)
+            {
+                body.str("");
+                body << "        if(state.fetch(1))\n"
+                     << "        {\n"
+                     << "            state.cache().set(*state.current());\n"
+                     << "            state.advance(1);\n"
+                     << "            return RCode::SUCCESS;\n"
+                     << "        }\n"
+                     << "        return Scanners::fail(state, must, "
+                     << "expected(" << id << "));\n";
+            }
+            break;
+        }
+        case Pattern::Kind::LITERAL:
+        {
+            std::size_t n = node.d_text.size();
+            if(!n)
+            {
+                body << "        return RCode::SUCCESS;\n";
+                break;
+            }
+            body << "        if(state.fetch(" << n << ") >= " << n << " &&\n"
+                 << "           0 == std::memcmp(state.current(), "
+                 << stringLiteral(node.d_text) << ", " << n << "))\n"
+                 << "        {\n"
+                 << "            state.advance(" << n << ");\n"
+                 << "            return RCode::SUCCESS;\n"
+                 << "        }\n"
+                 << "        return Scanners::fail(state, must, expected("
+                 << expected("\"" + node.d_text + "\"") << "));\n";
+            break;
+        }
+        case Pattern::Kind::SEQ:
+            body << "        SavedPos pos(state);\n";
+            for(auto it = children.begin(); it != children.end(); ++it)
+            {
+                if(alwaysSucceeds(*it))
+                {
+                    body << "        " << call(*it, "must") << ";\n";
+                    continue;
+                }
+                body << "        if(RCode::FAIL == " << call(*it, "must")
+                     << ")\n"
+                     << "        {\n"
+                     << "            pos.rewind(state);\n"
+                     << "            return RCode::FAIL;\n"
+                     << "        }\n";
+            }
+            body << "        return RCode::SUCCESS;\n";
+            break;
+        case Pattern::Kind::CHOICE:
+            choice(children, body);
+            break;
+        case Pattern::Kind::STAR:
+        case Pattern::Kind::PLUS:
+        {
+            const Pattern::Node& child = children[0].node();
+            if(Pattern::Kind::PLUS == node.d_kind)
+            {
+                body << "        if(RCode::FAIL == "
+                     << call(children[0], "must") << ")\n"
+                     << "        {\n"
+                     << "            return RCode::FAIL;\n"
+                     << "        }\n";
+            }
+            if(Pattern::Kind::CLASS == child.d_kind)
+            {
+                // scan a chunk at a time, caching the last character
+                body << "        while(std::size_t n = "
+                     << "state.fetch(k_SPAN_CHUNK))\n"
+                     << "        {\n"
+                     << "            const char* p = state.current();\n"
+                     << "            std::size_t m = 0;\n"
+                     << "            for(; m < n; ++m)\n"
+                     << "            {\n"
+                     << "                unsigned char c = "
+                     << "static_cast<unsigned char>(p[m]);\n"
+                     << "                if(!"
+                     << negatable(condition(child.d_class))
+                     << ") break;\n"
+                     << "            }\n"
+                     << "            if(m)\n"
+                     << "            {\n"
+                     << "                state.cache().set(p[m - 1]);\n"
+                     << "                state.advance(m);\n"
+                     << "            }\n"
+                     << "            if(m < n) break;\n"
+                     << "        }\n";
+            }
+            else
+            {
+                body << "        while(RCode::FAIL != "
+                     << call(children[0], "false") << ") ;\n";
+            }
+            body << "        return RCode::SUCCESS;\n";
+            break;
+        }
+        case Pattern::Kind::QMARK:
+            body << "        " << call(children[0], "false") << ";\n"
+                 << "        return RCode::SUCCESS;\n";
+            break;
+        case Pattern::Kind::PTEST:
+        case Pattern::Kind::NTEST:
+            body << "        SavedPos pos(state);\n"
+                 << "        RCode rc = " << call(children[0], "false")
+                 << ";\n"
+                 << "        pos.rewind(state);\n"
+                 << "        return RCode::"
+                 << (Pattern::Kind::PTEST == node.d_kind ?
+                     "FAIL" : "SUCCESS")
+                 << " == rc ? RCode::FAIL : RCode::SUCCESS;\n";
+            break;
+        case Pattern::Kind::ACTION:
+            body << "        SavedPos pos(state);\n"
+                 << "        d_actors." << node.d_text << "(state);\n"
+                 << "        pos.rewind(state);\n"
+                 << "        return RCode::SUCCESS;\n";
+            break;
+        case Pattern::Kind::RULE:
+            body << "        return " << call(pattern, "must") << ";\n";
+            break;
+        }
+
+        d_functions << "    RCode " << name
+                    << "(State& state, bool must) const\n"
+                    << "    {\n"
+                    << body.str()
+                    << "    }\n\n";
+        return name;
+    }
+
+    // Emit the tries of 'alternatives' in order, the last one with
+    // 'must'.
+    void tries(const std::vector<const Pattern*>& alternatives,
+               const std::string& indent,
+               std::ostream& body)
+    {
+        for(std::size_t i = 0; i + 1 < alternatives.size(); ++i)
+        {
+            body << indent << "if(RCode::SUCCESS == "
+                 << call(*alternatives[i], "false") << ")\n"
+                 << indent << "{\n"
+                 << indent << "    return RCode::SUCCESS;\n"
+                 << indent << "}\n";
+        }
+        body << indent << "return " << call(*alternatives.back(), "must")
+             << ";\n";
+    }
+
+    // Emit an ordered choice over 'children' that only tries the
+    // alternatives able to start with the next character, as
+    // Combinators::dispatch does.
+    void choice(const std::vector<Pattern>& children, std::ostream& body)
+    {
+        std::vector<First> firsts;
+        bool nullable = true;
+        for(auto it = children.begin(); it != children.end(); ++it)
+        {
+            firsts.push_back(first(*it));
+            nullable = nullable && firsts.back().d_nullable;
+        }
+        std::vector<const Pattern*> all;
+        for(auto it = children.begin(); it != children.end(); ++it)
+        {
+            all.push_back(&*it);
+        }
+        if(nullable)
+        {
+            tries(all, "        ", body);
+            return;
+        }
+
+        // group the characters by the alternatives they select
+        std::vector<const Pattern*> wildcards;
+        for(std::size_t i = 0; i < children.size(); ++i)
+        {
+            if(firsts[i].d_nullable) wildcards.push_back(&children[i]);
+        }
+        std::map<std::vector<std::size_t>, std::vector<int> > cases;
+        for(int c = 0; c < 256; ++c)
+        {
+            std::vector<std::size_t> selected;
+            for(std::size_t i = 0; i < children.size(); ++i)
+            {
+                if(firsts[i].d_nullable || firsts[i].d_chars[c])
+                {
+                    selected.push_back(i);
+                }
+            }
+            if(selected.size() != wildcards.size())
+            {
+                cases[selected].push_back(c);
+            }
+        }
+
+        body << "        int c = state.fetch(1) ?\n"
+             << "            static_cast<unsigned char>(*state.current()) "
+             << ": -1;\n"
+             << "        switch(c)\n"
+             << "        {\n";
+        for(auto it = cases.begin(); it != cases.end(); ++it)
+        {
+            for(std::size_t i = 0; i < it->second.size(); ++i)
+            {
+                body << (i % 6 ? " " : i ? "\n        " : "        ")
+                     << "case " << charLiteral(it->second[i]) << ":";
+            }
+            body << "\n        {\n";
+            std::vector<const Pattern*> alternatives;
+            for(auto i = it->first.begin(); i != it->first.end(); ++i)
+            {
+                alternatives.push_back(&children[*i]);
+            }
+            tries(alternatives, "            ", body);
+            body << "        }\n";
+        }
+        body << "        default:\n"
+             << "        {\n";
+        if(wildcards.empty())
+        {
+            // like choice, let the last alternative report the failure
+            body << "            return must ? "
+                 << call(children.back(), "must") << " : RCode::FAIL;\n";
+        }
+        else
+        {
+            tries(wildcards, "            ", body);
+        }
+        body << "        }\n"
+             << "        }\n";
+    }
+
+public:
+    // CREATORS
+    explicit Generator(const PegGrammar& grammar)
+        : d_grammar(grammar)
+    {
+        for(auto it = grammar.d_rules.begin();
+            it != grammar.d_rules.end(); ++it)
+        {
+            d_rules[it->first] = &it->second;
+        }
+        for(auto it = grammar.d_rules.begin();
+            it != grammar.d_rules.end(); ++it)
+        {
+            check(it->second);
+        }
+        computeFirsts();
+        checkTermination();
+    }
+
+    // MANIPULATORS
+    std::string generate(const GenOptions& options)
+    {
+        std::string className =
+            options.d_className.empty() ? "Parser" : options.d_className;
+        std::string guard = options.d_guard;
+        if(guard.empty())
+        {
+            guard = "INCLUDED_";
+            std::string name = options.d_namespace + "_" + className;
+            for(std::size_t i = 0; i < name.size(); ++i)
+            {
+                if(std::isalnum(static_cast<unsigned char>(name[i])))
+                {
+                    guard += static_cast<char>(
+                        std::toupper(static_cast<unsigned char>(name[i])));
+                }
+                else if('_' != guard.back())
+                {
+                    guard += '_';
+                }
+            }
+            guard += "_H";
+        }
+        std::string source =
+            options.d_source.empty() ? "a PEG grammar" : options.d_source;
+
+        std::ostringstream rules;
+        for(auto it = d_grammar.d_rules.begin();
+            it != d_grammar.d_rules.end(); ++it)
+        {
+            rules << "\n"
+                  << "    RCode rule_" << it->first
+                  << "(State& state, bool must) const\n"
+                  << "    {\n"
+                  << "        return " << call(it->second, "must") << ";\n"
+                  << "    }\n";
+        }
+
+        std::vector<std::string> namespaces;
+        for(std::size_t begin = 0; begin < options.d_namespace.size(); )
+        {
+            std::size_t end = options.d_namespace.find("::", begin);
+            if(std::string::npos == end) end = options.d_namespace.size();
+            namespaces.push_back(
+                options.d_namespace.substr(begin, end - begin));
+            begin = end + 2;
+        }
+
+        bool hasActors = !d_actions.empty();
+        std::ostringstream out;
+        out << "// Generated by yapeg-gen from " << source
+            << "; do not edit.\n"
+            << "#ifndef " << guard << "\n"
+            << "#define " << guard << "\n"
+            << "\n"
+            << "#include <yapeg_combinators.h>\n"
+            << "#include <yapeg_scanners.h>\n"
+            << "#include <cstddef>\n"
+            << "#include <cstring>\n"
+            << "#include <string>\n"
+            << "\n";
+        for(auto it = namespaces.begin(); it != namespaces.end(); ++it)
+        {
+            out << "namespace " << *it << " {\n\n";
+        }
+        out << "// Recursive-descent parser for " << source
+            << ", starting at rule " << d_grammar.d_rules[0].first << ".\n";
+        if(hasActors)
+        {
+            out << "// Actors must have members callable as";
+            std::size_t column = 39;
+            for(auto it = d_actions.begin(); it != d_actions.end(); ++it)
+            {
+                std::string item = " " + *it + "(state)" +
+                    (std::next(it) != d_actions.end() ? "," : ".");
+                if(column + item.size() > 76)
+                {
+                    out << "\n//  ";
+                    column = 4;
+                }
+                out << item;
+                column += item.size();
+            }
+            out << "\n"
+                << "template<typename State, typename Actors>\n";
+        }
+        else
+        {
+            out << "template<typename State>\n";
+        }
+        out << "class " << className << "\n"
+            << "{\n"
+            << "public:\n"
+            << "    // TYPES\n"
+            << "    using RCode = typename yapeg::Combinators<State>::RCode;"
+            << "\n\n"
+            << "private:\n"
+            << "    // TYPES\n"
+            << "    using SavedPos = typename "
+            << "yapeg::Combinators<State>::SavedPos;\n"
+            << "    using Scanners = yapeg::Scanners<State>;\n"
+            << "\n"
+            << "    // CONSTANTS\n"
+            << "    enum { k_SPAN_CHUNK = 4096 };\n"
+            << "\n";
+        if(hasActors)
+        {
+            out << "    // DATA\n"
+                << "    Actors& d_actors;\n"
+                << "\n";
+        }
+        out << "public:\n";
+        if(hasActors)
+        {
+            out << "    // CREATORS\n"
+                << "    explicit " << className << "(Actors& actors)\n"
+                << "        : d_actors(actors) {}\n"
+                << "\n";
+        }
+        out << "    // ACCESSORS\n"
+            << "    RCode parse(State& state, bool must = false) const\n"
+            << "    {\n"
+            << "        return rule_" << d_grammar.d_rules[0].first
+            << "(state, must);\n"
+            << "    }\n"
+            << "\n"
+            << "    // Same as parse, so that the parser can be a Combinators "
+            << "Parser.\n"
+            << "    RCode operator() (State& state, bool must) const\n"
+            << "    {\n"
+            << "        return parse(state, must);\n"
+            << "    }\n"
+            << rules.str()
+            << "\n"
+            << "private:\n"
+            << "    // CLASS METHODS\n";
+        if(!d_expected.empty())
+        {
+            out << "    static const std::string& expected(std::size_t i)\n"
+                << "    {\n"
+                << "        static const std::string s_expected[] = {";
+            for(std::size_t i = 0; i < d_expected.size(); ++i)
+            {
+                out << (i ? ",\n" : "\n") << "            "
+                    << stringLiteral(d_expected[i]);
+            }
+            out << "\n"
+                << "        };\n"
+                << "        return s_expected[i];\n"
+                << "    }\n"
+                << "\n";
+        }
+        out << d_helpers.str()
+            << "    // ACCESSORS\n"
+            << d_functions.str();
+        // drop the blank line after the last function
+        std::string text = out.str();
+        if(text.size() > 1 && '\n' == text[text.size() - 2])
+        {
+            text.erase(text.size() - 1);
+        }
+        out.str("");
+        out << text
+            << "};\n";
+        for(auto it = namespaces.rbegin(); it != namespaces.rend(); ++it)
+        {
+            out << "\n} // close namespace " << *it << "\n";
+        }
+        out << "\n"
+            << "#endif // " << guard << "\n";
+        return out.str();
+    }
+};
+
+} // close anonymous namespace
+
+PegGrammar readPeg(const std::string& text)
+{
+    return PegReader(text).grammar();
+}
+
+std::string generateParser(const PegGrammar& grammar,
+                           const GenOptions& options)
+{
+    return Generator(grammar).generate(options);
+}
+
+} // close namespace yapeg
@@ -0,0 +1,62 @@
+#ifndef INCLUDED_YAPEG_GEN_H
+#define INCLUDED_YAPEG_GEN_H
+
+// Offline generation of recursive-descent C++ parsers from PEG grammar
+// text, as done by the yapeg-gen tool.  The grammar text is
+//
+//   # comment to the end of line
+//   Rule   <- Expr             the first rule is the start rule
+//   a / b     ordered choice     a b       sequence
+//   &a  !a    and / not tests    a* a+ a?  repetitions
+//   (a)       grouping           Rule      rule reference
+//   'x' "x"   literal            [a-z_]    class, [^...] to negate
+//   .         any character      {name}    call of actor 'name'
+//
+// with the escapes \n \r \t \\ \' \" \[ \] \- and \xHH in literals and
+// classes.  The generated class template runs against the Scanners
+// State contract with Combinators' RCode and 'must' semantics: leaves
+// cache the character they match, report failures through
+// Scanners::fail, and the position is saved with Combinators::SavedPos.
+// Each operator becomes a member function making direct calls, class
+// tests are inlined, and a choice switches on the next character to the
+// alternatives that can start with it; like Combinators::dispatch, the
+// alternatives skipped record no failure.
+
+#include <yapeg_machine.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace yapeg {
+
+// Rules in the order of the grammar text; the first is the start rule.
+struct PegGrammar
+{
+    std::vector<std::pair<std::string, Pattern> > d_rules;
+};
+
+struct GenOptions
+{
+    std::string d_className;   // default "Parser"
+    std::string d_namespace;   // may be nested as "a::b", empty for none
+    std::string d_guard;       // include guard, derived if empty
+    std::string d_source;      // grammar file name, for comments
+};
+
+// Parse the grammar text 'text'.  Throw std::invalid_argument, with the
+// line number, on a syntax error or a rule defined twice.
+PegGrammar readPeg(const std::string& text);
+
+// Return a header defining the parser of 'grammar'.  The class is
+// templated on the State and, if the grammar has actions, on an Actors
+// type with a member callable as 'name(state)' for each {name}; a struct
+// of Combinators<State>::Actor members does.  Throw std::invalid_argument
+// if a referenced rule is missing, if a rule is left-recursive, or if a
+// star or plus repeats an expression that may match nothing, as the
+// parser would never return.
+std::string generateParser(const PegGrammar& grammar,
+                           const GenOptions& options);
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_GEN_H
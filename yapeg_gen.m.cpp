@@ -0,0 +1,85 @@
+// yapeg-gen: generate a recursive-descent C++ parser from a PEG grammar.
+//
+// usage: yapeg-gen [-c class] [-n namespace] [-g guard] [-o output] grammar
+//
+// The header is written to 'output', or to the standard output.
+
+#include <yapeg_gen.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+int usage()
+{
+    std::cerr << "usage: yapeg-gen [-c class] [-n namespace] [-g guard] "
+              << "[-o output] grammar" << std::endl;
+    return 2;
+}
+
+} // close anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    yapeg::GenOptions options;
+    std::string output;
+    std::string input;
+    for(int i = 1; i < argc; ++i)
+    {
+        if('-' == argv[i][0] && i + 1 < argc && 2 == std::strlen(argv[i]))
+        {
+            switch(argv[i][1])
+            {
+            case 'c': options.d_className = argv[++i]; continue;
+            case 'n': options.d_namespace = argv[++i]; continue;
+            case 'g': options.d_guard = argv[++i]; continue;
+            case 'o': output = argv[++i]; continue;
+            }
+            return usage();
+        }
+        if(!input.empty()) return usage();
+        input = argv[i];
+    }
+    if(input.empty()) return usage();
+
+    std::ifstream in(input.c_str(), std::ios::binary);
+    if(!in)
+    {
+        std::cerr << "yapeg-gen: cannot read " << input << std::endl;
+        return 1;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    std::size_t slash = input.find_last_of('/');
+    options.d_source =
+        std::string::npos == slash ? input : input.substr(slash + 1);
+
+    std::string header;
+    try
+    {
+        header = yapeg::generateParser(yapeg::readPeg(text.str()), options);
+    }
+    catch(const std::invalid_argument& e)
+    {
+        std::cerr << input << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    if(output.empty())
+    {
+        std::cout << header;
+        return 0;
+    }
+    std::ofstream out(output.c_str(), std::ios::binary);
+    out << header;
+    if(!out)
+    {
+        std::cerr << "yapeg-gen: cannot write " << output << std::endl;
+        return 1;
+    }
+    return 0;
+}
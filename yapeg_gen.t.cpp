@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+#include <yapeg_gen.h>
+#include <yapeg_gen_expr.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_streamstate.h>
+#include <yapeg_combinators.h>
+#include <yapeg_failure.h>
+#include <yapeg_scanners.h>
+#include <yapeg_machine.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+namespace {
+
+// Actors of yapeg_gen_expr.peg evaluating on a stack.
+struct Calculator
+{
+    std::vector<long> d_stack;
+    std::size_t d_mark;
+    std::string d_text;   // input, for the token texts
+    std::map<std::string, long> d_variables;
+
+    template<typename State>
+    void mark(State& state) { d_mark = state.getPos(); }
+
+    template<typename State>
+    void number(State& state)
+    {
+        d_stack.push_back(std::stol(token(state)));
+    }
+
+    template<typename State>
+    void variable(State& state)
+    {
+        d_stack.push_back(d_variables[token(state)]);
+    }
+
+    template<typename State> void add(State&) { apply('+'); }
+    template<typename State> void sub(State&) { apply('-'); }
+    template<typename State> void mul(State&) { apply('*'); }
+    template<typename State> void div(State&) { apply('/'); }
+    template<typename State> void mod(State&) { apply('%'); }
+
+    template<typename State>
+    std::string token(State& state) const
+    {
+        return d_text.substr(d_mark, state.getPos() - d_mark);
+    }
+
+    void apply(char op)
+    {
+        long rhs = d_stack.back();
+        d_stack.pop_back();
+        long& lhs = d_stack.back();
+        switch(op)
+        {
+        case '+': lhs += rhs; break;
+        case '-': lhs -= rhs; break;
+        case '*': lhs *= rhs; break;
+        case '/': lhs /= rhs; break;
+        case '%': lhs %= rhs; break;
+        }
+    }
+};
+
+using Parser = ExprParser<BufferState, Calculator>;
+
+bool evaluate(const std::string& text, long& value)
+{
+    Calculator calculator;
+    calculator.d_text = text;
+    calculator.d_variables["x"] = 7;
+    BufferState state(text);
+    if(Parser::RCode::SUCCESS != Parser(calculator).parse(state))
+    {
+        return false;
+    }
+    EXPECT_EQ(calculator.d_stack.size(), 1u);
+    value = calculator.d_stack.back();
+    return true;
+}
+
+} // close anonymous namespace
+
+TEST(Gen, readPeg)
+{
+    PegGrammar grammar = readPeg(
+        "# comment\n"
+        "list <- item (',' item)* !.\n"
+        "item <- [a-z_]+ / '\"\\x41' {found}  # another\n");
+    ASSERT_EQ(grammar.d_rules.size(), 2u);
+    EXPECT_EQ(grammar.d_rules[0].first, "list");
+    EXPECT_EQ(grammar.d_rules[1].first, "item");
+
+    const Pattern::Node& list = grammar.d_rules[0].second.node();
+    ASSERT_EQ(list.d_kind, Pattern::Kind::SEQ);
+    ASSERT_EQ(list.d_children.size(), 3u);
+    EXPECT_EQ(list.d_children[0].node().d_kind, Pattern::Kind::RULE);
+    EXPECT_EQ(list.d_children[1].node().d_kind, Pattern::Kind::STAR);
+    EXPECT_EQ(list.d_children[2].node().d_kind, Pattern::Kind::NTEST);
+
+    const Pattern::Node& item = grammar.d_rules[1].second.node();
+    ASSERT_EQ(item.d_kind, Pattern::Kind::CHOICE);
+    const Pattern::Node& quoted = item.d_children[1].node();
+    ASSERT_EQ(quoted.d_kind, Pattern::Kind::SEQ);
+    EXPECT_EQ(quoted.d_children[0].node().d_text, "\"A");
+    EXPECT_EQ(quoted.d_children[1].node().d_kind, Pattern::Kind::ACTION);
+    EXPECT_EQ(quoted.d_children[1].node().d_text, "found");
+
+    // without actions, the grammar also compiles to a Program
+    PegGrammar digits = readPeg("n <- [0-9]+ ('.' [0-9]+)?");
+    Program program(digits.d_rules[0].second);
+    std::string text("3.14x");
+    EXPECT_EQ(program.match(text.data(), text.data() + text.size()), 4u);
+}
+
+TEST(Gen, readPegErrors)
+{
+    try
+    {
+        readPeg("a <- 'x'\nb <- 'y\n");
+        FAIL();
+    }
+    catch(const std::invalid_argument& e)
+    {
+        EXPECT_EQ(std::string(e.what()), "line 3: unterminated literal");
+    }
+    EXPECT_THROW(readPeg(""), std::invalid_argument);
+    EXPECT_THROW(readPeg("a <- 'x'\na <- 'y'"), std::invalid_argument);
+    EXPECT_THROW(readPeg("a <- ('x'"), std::invalid_argument);
+    EXPECT_THROW(readPeg("a <- [z-a]"), std::invalid_argument);
+    EXPECT_THROW(readPeg("a <- '\\q'"), std::invalid_argument);
+    EXPECT_THROW(readPeg("a <- {}"), std::invalid_argument);
+}
+
+TEST(Gen, generateParser)
+{
+    GenOptions options;
+    options.d_className = "Digits";
+    options.d_namespace = "app::parse";
+    std::string header =
+        generateParser(readPeg("n <- [0-9]+ / 'x' / 'y'"), options);
+    EXPECT_NE(header.find("#ifndef INCLUDED_APP_PARSE_DIGITS_H"),
+              std::string::npos);
+    EXPECT_NE(header.find("namespace app {\n\nnamespace parse {"),
+              std::string::npos);
+    EXPECT_NE(header.find("template<typename State>\nclass Digits"),
+              std::string::npos);
+    EXPECT_EQ(header.find("Actors"), std::string::npos);
+    EXPECT_NE(header.find("switch(c)"), std::string::npos);
+    EXPECT_NE(header.find("if(c >= '0' && c <= '9')"), std::string::npos);
+
+    EXPECT_THROW(generateParser(readPeg("a <- b"), options),
+                 std::invalid_argument);
+
+    // parsers that would never return
+    EXPECT_THROW(generateParser(readPeg("a <- a 'x' / 'y'"), options),
+                 std::invalid_argument);
+    EXPECT_THROW(generateParser(readPeg("a <- 'x'? b\nb <- !'z' a"),
+                                options),
+                 std::invalid_argument);
+    EXPECT_THROW(generateParser(readPeg("a <- ''*"), options),
+                 std::invalid_argument);
+    EXPECT_THROW(generateParser(readPeg("a <- ('x' / b)+\nb <- 'y'?"),
+                                options),
+                 std::invalid_argument);
+    generateParser(readPeg("a <- 'x' a / 'y' ('z' b)*\nb <- a?"), options);
+}
+
+TEST(Gen, generatedParser)
+{
+    long value = 0;
+    EXPECT_TRUE(evaluate("42", value));
+    EXPECT_EQ(value, 42);
+    EXPECT_TRUE(evaluate(" 1 + 2 * 3 - 4", value));
+    EXPECT_EQ(value, 3);
+    EXPECT_TRUE(evaluate("(1 + 2) * x  # comment\n - 10 mod 4", value));
+    EXPECT_EQ(value, 19);
+    EXPECT_TRUE(evaluate("modulo mod 5", value));
+    EXPECT_EQ(value, 0);
+
+    EXPECT_FALSE(evaluate("", value));
+    EXPECT_FALSE(evaluate("1 +", value));
+    EXPECT_FALSE(evaluate("(1", value));
+    EXPECT_FALSE(evaluate("1 2", value));
+}
+
+TEST(Gen, generatedFailures)
+{
+    std::string text("(1 + 2 * ) - 3");
+    Calculator calculator;
+    calculator.d_text = text;
+    Parser parser(calculator);
+
+    BufferState state(text);
+    FarthestFailure failure;
+    EXPECT_FALSE(parseTracked(parser, state, failure));
+    // as with Combinators::dispatch, the alternatives skipped by the
+    // switch on ')' record nothing, so the farthest failure is the
+    // missing Close
+    EXPECT_EQ(failure.pos(), 7u);
+    EXPECT_EQ(failure.expected(), std::vector<std::string>({ "')'" }));
+
+    // with 'must', the Close after the parenthesized Sum is required
+    calculator.d_stack.clear();
+    state.setPos(0);
+    try
+    {
+        parser.parse(state, true);
+        FAIL();
+    }
+    catch(const ScanError& e)
+    {
+        EXPECT_EQ(e.pos(), 7u);
+        EXPECT_EQ(e.expected(), "')'");
+    }
+}
+
+TEST(Gen, generatedCombined)
+{
+    // a rule of the generated parser as a leaf of a combinator grammar
+    // over a State releasing its input
+    using Cbnt = Combinators<StreamState>;
+    using Scn = Scanners<StreamState>;
+    std::string text("1+2;3*4;x-1;");
+    Calculator calculator;
+    calculator.d_text = text;
+    calculator.d_variables["x"] = 5;
+    ExprParser<StreamState, Calculator> expr(calculator);
+    std::vector<long> results;
+    Cbnt::Parser statement = Cbnt::seq({
+            [&](StreamState& state, bool must) {
+                return expr.rule_Sum(state, must);
+            },
+            Scn::ch(';'),
+            Cbnt::yaction([&](StreamState&) {
+                    results.push_back(calculator.d_stack.back());
+                    calculator.d_stack.clear();
+                })
+        });
+
+    std::size_t offset = 0;
+    StreamState state(
+        [&](char* buffer, std::size_t size) {
+            std::size_t n = std::min<std::size_t>(
+                std::min<std::size_t>(size, 2), text.size() - offset);
+            std::memcpy(buffer, text.data() + offset, n);
+            offset += n;
+            return n;
+        }, 4);
+    while(state.fetch(1))
+    {
+        ASSERT_EQ(Cbnt::RCode::SUCCESS, statement(state, true));
+    }
+    EXPECT_EQ(results, std::vector<long>({ 3, 12, 4 }));
+}
+
+} // close namespace yapeg
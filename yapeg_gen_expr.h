@@ -0,0 +1,951 @@
+// Generated by yapeg-gen from yapeg_gen_expr.peg; do not edit.
+#ifndef INCLUDED_YAPEG_EXPRPARSER_H
+#define INCLUDED_YAPEG_EXPRPARSER_H
+
+#include <yapeg_combinators.h>
+#include <yapeg_scanners.h>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace yapeg {
+
+// Recursive-descent parser for yapeg_gen_expr.peg, starting at rule Expr.
+// Actors must have members callable as add(state), div(state), mark(state),
+//   mod(state), mul(state), number(state), sub(state), variable(state).
+template<typename State, typename Actors>
+class ExprParser
+{
+public:
+    // TYPES
+    using RCode = typename yapeg::Combinators<State>::RCode;
+
+private:
+    // TYPES
+    using SavedPos = typename yapeg::Combinators<State>::SavedPos;
+    using Scanners = yapeg::Scanners<State>;
+
+    // CONSTANTS
+    enum { k_SPAN_CHUNK = 4096 };
+
+    // DATA
+    Actors& d_actors;
+
+public:
+    // CREATORS
+    explicit ExprParser(Actors& actors)
+        : d_actors(actors) {}
+
+    // ACCESSORS
+    RCode parse(State& state, bool must = false) const
+    {
+        return rule_Expr(state, must);
+    }
+
+    // Same as parse, so that the parser can be a Combinators Parser.
+    RCode operator() (State& state, bool must) const
+    {
+        return parse(state, must);
+    }
+
+    RCode rule_Expr(State& state, bool must) const
+    {
+        return e0(state, must);
+    }
+
+    RCode rule_Sum(State& state, bool must) const
+    {
+        return e3(state, must);
+    }
+
+    RCode rule_Product(State& state, bool must) const
+    {
+        return e10(state, must);
+    }
+
+    RCode rule_Value(State& state, bool must) const
+    {
+        return e19(state, must);
+    }
+
+    RCode rule_Number(State& state, bool must) const
+    {
+        return e21(state, must);
+    }
+
+    RCode rule_Name(State& state, bool must) const
+    {
+        return e26(state, must);
+    }
+
+    RCode rule_Add(State& state, bool must) const
+    {
+        return e31(state, must);
+    }
+
+    RCode rule_Sub(State& state, bool must) const
+    {
+        return e33(state, must);
+    }
+
+    RCode rule_Mul(State& state, bool must) const
+    {
+        return e35(state, must);
+    }
+
+    RCode rule_Div(State& state, bool must) const
+    {
+        return e37(state, must);
+    }
+
+    RCode rule_Mod(State& state, bool must) const
+    {
+        return e39(state, must);
+    }
+
+    RCode rule_Open(State& state, bool must) const
+    {
+        return e43(state, must);
+    }
+
+    RCode rule_Close(State& state, bool must) const
+    {
+        return e45(state, must);
+    }
+
+    RCode rule_Spacing(State& state, bool must) const
+    {
+        return e47(state, must);
+    }
+
+private:
+    // CLASS METHODS
+    static const std::string& expected(std::size_t i)
+    {
+        static const std::string s_expected[] = {
+            "any character",
+            "[0-9]",
+            "[$A-Z_a-z]",
+            "'+'",
+            "'-'",
+            "'*'",
+            "'/'",
+            "\"mod\"",
+            "[$0-9A-Z_a-z]",
+            "'('",
+            "')'",
+            "[\011\012\015 ]",
+            "'#'"
+        };
+        return s_expected[i];
+    }
+
+    static bool inSet0(unsigned char c)
+    {
+        return c == '$' ||
+            (c >= 'A' && c <= 'Z') ||
+            c == '_' ||
+            (c >= 'a' && c <= 'z');
+    }
+
+    static bool inSet1(unsigned char c)
+    {
+        static const unsigned char k_BITS[32] = {
+            0, 0, 0, 0, 16, 0, 255, 3,
+            254, 255, 255, 135, 254, 255, 255, 7,
+            0, 0, 0, 0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0, 0, 0, 0
+        };
+        return (k_BITS[c >> 3] >> (c & 7)) & 1;
+    }
+
+    static bool inSet2(unsigned char c)
+    {
+        return (c >= '\t' && c <= '\n') ||
+            c == '\r' ||
+            c == ' ';
+    }
+
+    // ACCESSORS
+    RCode e2(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            state.cache().set(*state.current());
+            state.advance(1);
+            return RCode::SUCCESS;
+        }
+        return Scanners::fail(state, must, expected(0));
+    }
+
+    RCode e1(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        RCode rc = e2(state, false);
+        pos.rewind(state);
+        return RCode::SUCCESS == rc ? RCode::FAIL : RCode::SUCCESS;
+    }
+
+    RCode e0(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == rule_Spacing(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Sum(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == e1(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e7(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        d_actors.add(state);
+        pos.rewind(state);
+        return RCode::SUCCESS;
+    }
+
+    RCode e6(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == rule_Add(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Product(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        e7(state, must);
+        return RCode::SUCCESS;
+    }
+
+    RCode e9(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        d_actors.sub(state);
+        pos.rewind(state);
+        return RCode::SUCCESS;
+    }
+
+    RCode e8(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == rule_Sub(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Product(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        e9(state, must);
+        return RCode::SUCCESS;
+    }
+
+    RCode e5(State& state, bool must) const
+    {
+        int c = state.fetch(1) ?
+            static_cast<unsigned char>(*state.current()) : -1;
+        switch(c)
+        {
+        case '+':
+        {
+            return e6(state, must);
+        }
+        case '-':
+        {
+            return e8(state, must);
+        }
+        default:
+        {
+            return must ? e8(state, must) : RCode::FAIL;
+        }
+        }
+    }
+
+    RCode e4(State& state, bool must) const
+    {
+        while(RCode::FAIL != e5(state, false)) ;
+        return RCode::SUCCESS;
+    }
+
+    RCode e3(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == rule_Product(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        e4(state, must);
+        return RCode::SUCCESS;
+    }
+
+    RCode e14(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        d_actors.mul(state);
+        pos.rewind(state);
+        return RCode::SUCCESS;
+    }
+
+    RCode e13(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == rule_Mul(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Value(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        e14(state, must);
+        return RCode::SUCCESS;
+    }
+
+    RCode e16(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        d_actors.div(state);
+        pos.rewind(state);
+        return RCode::SUCCESS;
+    }
+
+    RCode e15(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == rule_Div(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Value(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        e16(state, must);
+        return RCode::SUCCESS;
+    }
+
+    RCode e18(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        d_actors.mod(state);
+        pos.rewind(state);
+        return RCode::SUCCESS;
+    }
+
+    RCode e17(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == rule_Mod(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Value(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        e18(state, must);
+        return RCode::SUCCESS;
+    }
+
+    RCode e12(State& state, bool must) const
+    {
+        int c = state.fetch(1) ?
+            static_cast<unsigned char>(*state.current()) : -1;
+        switch(c)
+        {
+        case '*':
+        {
+            return e13(state, must);
+        }
+        case '/':
+        {
+            return e15(state, must);
+        }
+        case 'm':
+        {
+            return e17(state, must);
+        }
+        default:
+        {
+            return must ? e17(state, must) : RCode::FAIL;
+        }
+        }
+    }
+
+    RCode e11(State& state, bool must) const
+    {
+        while(RCode::FAIL != e12(state, false)) ;
+        return RCode::SUCCESS;
+    }
+
+    RCode e10(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == rule_Value(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        e11(state, must);
+        return RCode::SUCCESS;
+    }
+
+    RCode e20(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == rule_Open(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Sum(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Close(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e19(State& state, bool must) const
+    {
+        int c = state.fetch(1) ?
+            static_cast<unsigned char>(*state.current()) : -1;
+        switch(c)
+        {
+        case '0': case '1': case '2': case '3': case '4': case '5':
+        case '6': case '7': case '8': case '9':
+        {
+            return rule_Number(state, must);
+        }
+        case '$': case 'A': case 'B': case 'C': case 'D': case 'E':
+        case 'F': case 'G': case 'H': case 'I': case 'J': case 'K':
+        case 'L': case 'M': case 'N': case 'O': case 'P': case 'Q':
+        case 'R': case 'S': case 'T': case 'U': case 'V': case 'W':
+        case 'X': case 'Y': case 'Z': case '_': case 'a': case 'b':
+        case 'c': case 'd': case 'e': case 'f': case 'g': case 'h':
+        case 'i': case 'j': case 'k': case 'l': case 'm': case 'n':
+        case 'o': case 'p': case 'q': case 'r': case 's': case 't':
+        case 'u': case 'v': case 'w': case 'x': case 'y': case 'z':
+        {
+            return rule_Name(state, must);
+        }
+        case '(':
+        {
+            return e20(state, must);
+        }
+        default:
+        {
+            return must ? e20(state, must) : RCode::FAIL;
+        }
+        }
+    }
+
+    RCode e22(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        d_actors.mark(state);
+        pos.rewind(state);
+        return RCode::SUCCESS;
+    }
+
+    RCode e24(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(c >= '0' && c <= '9')
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(1));
+    }
+
+    RCode e23(State& state, bool must) const
+    {
+        if(RCode::FAIL == e24(state, must))
+        {
+            return RCode::FAIL;
+        }
+        while(std::size_t n = state.fetch(k_SPAN_CHUNK))
+        {
+            const char* p = state.current();
+            std::size_t m = 0;
+            for(; m < n; ++m)
+            {
+                unsigned char c = static_cast<unsigned char>(p[m]);
+                if(!(c >= '0' && c <= '9')) break;
+            }
+            if(m)
+            {
+                state.cache().set(p[m - 1]);
+                state.advance(m);
+            }
+            if(m < n) break;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e25(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        d_actors.number(state);
+        pos.rewind(state);
+        return RCode::SUCCESS;
+    }
+
+    RCode e21(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        e22(state, must);
+        if(RCode::FAIL == e23(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        e25(state, must);
+        if(RCode::FAIL == rule_Spacing(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e27(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        d_actors.mark(state);
+        pos.rewind(state);
+        return RCode::SUCCESS;
+    }
+
+    RCode e28(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(inSet0(c))
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(2));
+    }
+
+    RCode e29(State& state, bool must) const
+    {
+        while(std::size_t n = state.fetch(k_SPAN_CHUNK))
+        {
+            const char* p = state.current();
+            std::size_t m = 0;
+            for(; m < n; ++m)
+            {
+                unsigned char c = static_cast<unsigned char>(p[m]);
+                if(!inSet1(c)) break;
+            }
+            if(m)
+            {
+                state.cache().set(p[m - 1]);
+                state.advance(m);
+            }
+            if(m < n) break;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e30(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        d_actors.variable(state);
+        pos.rewind(state);
+        return RCode::SUCCESS;
+    }
+
+    RCode e26(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        e27(state, must);
+        if(RCode::FAIL == e28(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        e29(state, must);
+        e30(state, must);
+        if(RCode::FAIL == rule_Spacing(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e32(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(c == '+')
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(3));
+    }
+
+    RCode e31(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == e32(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Spacing(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e34(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(c == '-')
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(4));
+    }
+
+    RCode e33(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == e34(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Spacing(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e36(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(c == '*')
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(5));
+    }
+
+    RCode e35(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == e36(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Spacing(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e38(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(c == '/')
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(6));
+    }
+
+    RCode e37(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == e38(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Spacing(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e40(State& state, bool must) const
+    {
+        if(state.fetch(3) >= 3 &&
+           0 == std::memcmp(state.current(), "mod", 3))
+        {
+            state.advance(3);
+            return RCode::SUCCESS;
+        }
+        return Scanners::fail(state, must, expected(7));
+    }
+
+    RCode e42(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(inSet1(c))
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(8));
+    }
+
+    RCode e41(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        RCode rc = e42(state, false);
+        pos.rewind(state);
+        return RCode::SUCCESS == rc ? RCode::FAIL : RCode::SUCCESS;
+    }
+
+    RCode e39(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == e40(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == e41(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Spacing(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e44(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(c == '(')
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(9));
+    }
+
+    RCode e43(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == e44(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Spacing(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e46(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(c == ')')
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(10));
+    }
+
+    RCode e45(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == e46(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        if(RCode::FAIL == rule_Spacing(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e49(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(inSet2(c))
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(11));
+    }
+
+    RCode e51(State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            unsigned char c = static_cast<unsigned char>(*state.current());
+            if(c == '#')
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return Scanners::fail(state, must, expected(12));
+    }
+
+    RCode e52(State& state, bool must) const
+    {
+        while(std::size_t n = state.fetch(k_SPAN_CHUNK))
+        {
+            const char* p = state.current();
+            std::size_t m = 0;
+            for(; m < n; ++m)
+            {
+                unsigned char c = static_cast<unsigned char>(p[m]);
+                if(!(c <= '\t' || c >= 11)) break;
+            }
+            if(m)
+            {
+                state.cache().set(p[m - 1]);
+                state.advance(m);
+            }
+            if(m < n) break;
+        }
+        return RCode::SUCCESS;
+    }
+
+    RCode e50(State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == e51(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        e52(state, must);
+        return RCode::SUCCESS;
+    }
+
+    RCode e48(State& state, bool must) const
+    {
+        int c = state.fetch(1) ?
+            static_cast<unsigned char>(*state.current()) : -1;
+        switch(c)
+        {
+        case '\t': case '\n': case '\r': case ' ':
+        {
+            return e49(state, must);
+        }
+        case '#':
+        {
+            return e50(state, must);
+        }
+        default:
+        {
+            return must ? e50(state, must) : RCode::FAIL;
+        }
+        }
+    }
+
+    RCode e47(State& state, bool must) const
+    {
+        while(RCode::FAIL != e48(state, false)) ;
+        return RCode::SUCCESS;
+    }
+};
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_EXPRPARSER_H
@@ -0,0 +1,35 @@
+#include <yapeg_grammar.h>
+#include <yapeg_parallel.h>
+
+namespace yapeg {
+
+std::vector<ParseResult> parseMany(const Grammar<BufferState>& grammar,
+                                   const std::vector<std::string>& inputs,
+                                   unsigned threads)
+{
+    using RCode = Grammar<BufferState>::RCode;
+    threads = workerCount(threads);
+    std::vector<ParseResult> results(inputs.size());
+    std::vector<std::unique_ptr<BufferState> > states(threads);
+    parallelFor(
+        inputs.size(), threads,
+        [&](unsigned worker, std::size_t i)
+        {
+            if(!states[worker])
+            {
+                states[worker].reset(new BufferState(inputs[i]));
+            }
+            BufferState& state = *states[worker];
+            state.reset(inputs[i]);
+            ParseResult& result = results[i];
+            result.d_success = RCode::SUCCESS == grammar.parse(state);
+            result.d_end = state.getPos();
+            if(result.d_success)
+            {
+                result.d_value = std::move(state.cache());
+            }
+        });
+    return results;
+}
+
+} // close namespace yapeg
@@ -0,0 +1,108 @@
+#ifndef INCLUDED_YAPEG_GRAMMAR_H
+#define INCLUDED_YAPEG_GRAMMAR_H
+
+#include <yapeg_any.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace yapeg {
+
+// Shareable handle on the start parser of a grammar.  Copies share the
+// parser and only const access is given.  The Rules given to the
+// constructor are frozen, so no copy of them can redefine or reset
+// them under a parse, and the last copy of the Grammar releases them to
+// break their cycles.  This makes the grammar's structure immutable;
+// its actors and leaf parsers are opaque to it, so a Grammar is safe to
+// use from several threads at once, each on its own State, only if they
+// keep their results in the State (see Combinators::pure) rather than
+// in captured variables (as Combinators::capture does).
+template<typename State>
+class Grammar
+{
+public:
+    // TYPES
+    using Parser = typename Combinators<State>::Parser;
+    using RCode = typename Combinators<State>::RCode;
+    using Rule = typename Combinators<State>::Rule;
+
+private:
+    // TYPES
+    struct Definition
+    {
+        Parser d_start;
+        std::vector<Rule> d_rules;
+
+        ~Definition()
+        {
+            for(auto it = d_rules.begin(); it != d_rules.end(); ++it)
+            {
+                it->release();
+            }
+        }
+    };
+
+    // DATA
+    std::shared_ptr<const Definition> d_def;
+
+public:
+    // CREATORS
+
+    // Start with 'start', freezing 'rules', which must be all the Rules
+    // it refers to.  Throw std::logic_error if one of them is undefined.
+    explicit Grammar(Parser start, std::vector<Rule> rules = {})
+    {
+        for(auto it = rules.begin(); it != rules.end(); ++it)
+        {
+            if(!it->isDefined())
+            {
+                throw std::logic_error("Grammar: undefined rule");
+            }
+        }
+        for(auto it = rules.begin(); it != rules.end(); ++it)
+        {
+            it->freeze();
+        }
+        std::shared_ptr<Definition> def = std::make_shared<Definition>();
+        def->d_start = std::move(start);
+        def->d_rules = std::move(rules);
+        d_def = std::move(def);
+    }
+
+    // ACCESSORS
+    RCode parse(State& state, bool must = false) const
+    {
+        return d_def->d_start(state, must);
+    }
+
+    const Parser& start() const
+    {
+        return d_def->d_start;
+    }
+};
+
+// Outcome of one parse by parseMany.
+struct ParseResult
+{
+    bool d_success;
+    std::size_t d_end;  // position after the parse
+    Any d_value;        // cache value left by a successful parse
+};
+
+// Parse each of 'inputs' with 'grammar' on 'threads' threads (the
+// hardware concurrency if 0), each reusing one BufferState across the
+// inputs it takes.  Return the results in the order of 'inputs'.  An
+// exception thrown by the grammar is rethrown once all threads have
+// stopped.
+std::vector<ParseResult> parseMany(const Grammar<BufferState>& grammar,
+                                   const std::vector<std::string>& inputs,
+                                   unsigned threads = 0);
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_GRAMMAR_H
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <yapeg_grammar.h>
+#include <yapeg_scanners.h>
+#include <yapeg_combinators.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using Scn = Scanners<BufferState>;
+
+void countDigits(BufferState& s)
+{
+    s.cache().set(static_cast<int>(s.getPos()));
+}
+
+// Digits, caching their count.
+Grammar<BufferState> digits()
+{
+    return
+        Grammar<BufferState>(
+            Cbnt::combo(Scn::plus(Scn::range('0', '9')),
+                        Cbnt::pure(&countDigits)));
+}
+
+} // close anonymous namespace
+
+TEST(Grammar, parse)
+{
+    Grammar<BufferState> g = digits();
+    Grammar<BufferState> copy = g;
+    EXPECT_EQ(&g.start(), &copy.start());
+
+    std::string text("123x");
+    BufferState state(text);
+    EXPECT_EQ(copy.parse(state), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 3u);
+    EXPECT_EQ(state.cache().get<int>(), 3);
+}
+
+TEST(Grammar, rules)
+{
+    // number <- digit number / digit
+    Cbnt::Rule number;
+    Cbnt::Parser digit = Scn::range('0', '9');
+    EXPECT_THROW(Grammar<BufferState>(number, { number }), std::logic_error);
+    EXPECT_FALSE(number.isFrozen());
+    number.define(Cbnt::choice({ Cbnt::seq({ digit, number }), digit }));
+    {
+        Grammar<BufferState> g(number, { number });
+        EXPECT_TRUE(number.isFrozen());
+        EXPECT_THROW(number.define(digit), std::logic_error);
+        EXPECT_THROW(Cbnt::Rule(number).reset(), std::logic_error);
+        EXPECT_TRUE(number.isDefined());
+
+        std::string text("123x");
+        BufferState state(text);
+        EXPECT_EQ(g.parse(state), Cbnt::RCode::SUCCESS);
+        EXPECT_EQ(state.getPos(), 3u);
+    }
+    // the last copy of the grammar breaks the cycle
+    EXPECT_FALSE(number.isDefined());
+}
+
+TEST(Grammar, pure)
+{
+    Cbnt::Actor actor =
+        Cbnt::pure([](BufferState& s) { s.cache().set(1); });
+    std::string text;
+    BufferState state(text);
+    actor(state);
+    EXPECT_EQ(state.cache().get<int>(), 1);
+}
+
+TEST(Grammar, parseMany)
+{
+    std::vector<std::string> inputs;
+    for(int i = 0; i < 200; ++i)
+    {
+        inputs.push_back(i % 10 ? std::string(i % 7 + 1, '7') : "x");
+    }
+
+    Grammar<BufferState> g = digits();
+    for(unsigned threads = 1; threads <= 3; ++threads)
+    {
+        std::vector<ParseResult> results = parseMany(g, inputs, threads);
+        ASSERT_EQ(results.size(), inputs.size());
+        for(int i = 0; i < 200; ++i)
+        {
+            EXPECT_EQ(results[i].d_success, i % 10 != 0);
+            if(results[i].d_success)
+            {
+                EXPECT_EQ(results[i].d_end, inputs[i].size());
+                EXPECT_EQ(results[i].d_value.get<int>(), i % 7 + 1);
+            }
+            else
+            {
+                EXPECT_EQ(results[i].d_end, 0u);
+            }
+        }
+    }
+
+    Grammar<BufferState> throwing(
+        [](BufferState& s, bool) -> Cbnt::RCode {
+            throw std::runtime_error("bad input");
+        });
+    EXPECT_THROW(parseMany(throwing, inputs, 2), std::runtime_error);
+}
+
+} // close namespace yapeg
@@ -0,0 +1,86 @@
+#include <yapeg_bench.h>
+#include <yapeg_ir.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <cassert>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using P = Pattern;
+
+const char* const k_COMMANDS[] = {
+    "select", "selectall", "set", "setenv", "show", "shutdown", "start",
+    "status", "stop", "store"
+};
+
+// lines   <- line*
+// line    <- ws? command (ws arg)* ws? '\n'
+// command <- 'select' !letter / 'selectall' !letter / ...
+// arg     <- ([a-z] / [0-9])+
+PatternRules commandRules()
+{
+    PatternRules rules;
+    std::vector<P> commands;
+    for(const char* command : k_COMMANDS)
+    {
+        commands.push_back(
+            P::seq({ P::literal(command), P::ntest(P::rule("letter")) }));
+    }
+    rules.insert(std::make_pair("command", P::choice(commands)));
+    rules.insert(std::make_pair("letter", P::range('a', 'z')));
+    rules.insert(std::make_pair("ws", P::plus(P::charset(" \t"))));
+    rules.insert(std::make_pair(
+        "arg",
+        P::plus(P::choice({ P::range('a', 'z'), P::range('0', '9') }))));
+    rules.insert(std::make_pair(
+        "line",
+        P::seq({
+            P::qmark(P::rule("ws")), P::rule("command"),
+            P::star(P::seq({ P::rule("ws"), P::rule("arg") })),
+            P::qmark(P::rule("ws")), P::ch('\n')
+        })));
+    rules.insert(std::make_pair("lines", P::star(P::rule("line"))));
+    return rules;
+}
+
+std::string commandInput()
+{
+    std::string text;
+    for(int i = 0; i < 5000; ++i)
+    {
+        text += k_COMMANDS[(i * 7) % 10];
+        text += " arg" + std::to_string(i) + " value\n";
+    }
+    return text;
+}
+
+void benchCommands(bench::Counters& counters, bool optimized)
+{
+    static const std::string input = commandInput();
+    static const PatternRules rules = commandRules();
+    static const Cbnt::Parser plain =
+        Lowering<BufferState>::lower(rules, "lines", {});
+    static const Cbnt::Parser fast =
+        Lowering<BufferState>::lower(optimize(rules), "lines", {});
+
+    BufferState state(input);
+    (optimized ? fast : plain)(state, false);
+    assert(state.getPos() == input.size());
+    counters.d_bytes += input.size();
+    counters.d_items += 5000;
+}
+bench::Registrar s_commands(
+    "ir/commands",
+    [](bench::Counters& c) { benchCommands(c, false); });
+bench::Registrar s_commandsOptimized(
+    "ir/commands_optimized",
+    [](bench::Counters& c) { benchCommands(c, true); });
+
+} // close anonymous namespace
+
+} // close namespace yapeg
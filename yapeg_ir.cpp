@@ -0,0 +1,362 @@
+#include <yapeg_ir.h>
+#include <algorithm>
+#include <set>
+
+namespace yapeg {
+
+namespace {
+
+// Return a node like 'pattern' with the children 'children'.
+Pattern rebuild(const Pattern& pattern, const std::vector<Pattern>& children)
+{
+    switch(pattern.node().d_kind)
+    {
+    case Pattern::Kind::SEQ:    return Pattern::seq(children);
+    case Pattern::Kind::CHOICE: return Pattern::choice(children);
+    case Pattern::Kind::STAR:   return Pattern::star(children[0]);
+    case Pattern::Kind::PLUS:   return Pattern::plus(children[0]);
+    case Pattern::Kind::QMARK:  return Pattern::qmark(children[0]);
+    case Pattern::Kind::PTEST:  return Pattern::ptest(children[0]);
+    case Pattern::Kind::NTEST:  return Pattern::ntest(children[0]);
+    default:                    return pattern;
+    }
+}
+
+// Return 'pattern' with 'pass' applied to its children.
+template<typename Pass>
+Pattern mapChildren(const Pattern& pattern, Pass pass)
+{
+    const std::vector<Pattern>& children = pattern.node().d_children;
+    if(children.empty()) return pattern;
+    std::vector<Pattern> mapped;
+    for(auto it = children.begin(); it != children.end(); ++it)
+    {
+        mapped.push_back(pass(*it));
+    }
+    return rebuild(pattern, mapped);
+}
+
+bool isEmptyLiteral(const Pattern& pattern)
+{
+    return Pattern::Kind::LITERAL == pattern.node().d_kind &&
+        pattern.node().d_text.empty();
+}
+
+// Return true if 'pattern' runs no actor and refers to no rule.
+bool isPure(const Pattern& pattern)
+{
+    const Pattern::Node& node = pattern.node();
+    if(Pattern::Kind::ACTION == node.d_kind ||
+       Pattern::Kind::RULE == node.d_kind)
+    {
+        return false;
+    }
+    return std::all_of(node.d_children.begin(), node.d_children.end(),
+                       isPure);
+}
+
+// Return the elements of 'pattern' as a sequence.
+std::vector<Pattern> elements(const Pattern& pattern)
+{
+    if(Pattern::Kind::SEQ == pattern.node().d_kind)
+    {
+        return pattern.node().d_children;
+    }
+    return std::vector<Pattern>(1, pattern);
+}
+
+// Return true if the elements of 'pattern' after the first are pure.
+bool isPureTail(const Pattern& pattern)
+{
+    std::vector<Pattern> rest = elements(pattern);
+    return std::all_of(rest.begin() + 1, rest.end(), isPure);
+}
+
+Pattern makeSeq(const std::vector<Pattern>& patterns)
+{
+    if(patterns.empty()) return Pattern::literal("");
+    return 1 == patterns.size() ? patterns[0] : Pattern::seq(patterns);
+}
+
+Pattern makeChoice(const std::vector<Pattern>& patterns)
+{
+    return 1 == patterns.size() ? patterns[0] : Pattern::choice(patterns);
+}
+
+std::size_t commonPrefix(const std::string& a, const std::string& b)
+{
+    std::size_t n = 0;
+    while(n < a.size() && n < b.size() && a[n] == b[n]) ++n;
+    return n;
+}
+
+bool isLiteral(const Pattern& pattern)
+{
+    return Pattern::Kind::LITERAL == pattern.node().d_kind &&
+        !pattern.node().d_text.empty();
+}
+
+// Return true if rule 'name' can reach itself.
+bool reaches(const PatternRules& rules,
+             const Pattern& pattern,
+             const std::string& name,
+             std::set<std::string>& visited)
+{
+    const Pattern::Node& node = pattern.node();
+    if(Pattern::Kind::RULE == node.d_kind)
+    {
+        if(node.d_text == name) return true;
+        auto rule = rules.find(node.d_text);
+        if(rule == rules.end() || !visited.insert(node.d_text).second)
+        {
+            return false;
+        }
+        return reaches(rules, rule->second, name, visited);
+    }
+    for(auto it = node.d_children.begin(); it != node.d_children.end();
+        ++it)
+    {
+        if(reaches(rules, *it, name, visited)) return true;
+    }
+    return false;
+}
+
+Pattern substitute(const Pattern& pattern,
+                   const PatternRules& rules,
+                   const std::set<std::string>& inlined)
+{
+    const Pattern::Node& node = pattern.node();
+    if(Pattern::Kind::RULE == node.d_kind && inlined.count(node.d_text))
+    {
+        return substitute(rules.find(node.d_text)->second, rules, inlined);
+    }
+    return mapChildren(
+        pattern,
+        [&](const Pattern& child) {
+            return substitute(child, rules, inlined);
+        });
+}
+
+} // close anonymous namespace
+
+bool equalPatterns(const Pattern& a, const Pattern& b)
+{
+    const Pattern::Node& x = a.node();
+    const Pattern::Node& y = b.node();
+    if(&x == &y) return true;
+    if(x.d_kind != y.d_kind || x.d_text != y.d_text ||
+       x.d_children.size() != y.d_children.size())
+    {
+        return false;
+    }
+    if(Pattern::Kind::CLASS == x.d_kind)
+    {
+        for(int c = 0; c < 256; ++c)
+        {
+            if(x.d_class.test(static_cast<char>(c)) !=
+               y.d_class.test(static_cast<char>(c)))
+            {
+                return false;
+            }
+        }
+    }
+    for(std::size_t i = 0; i < x.d_children.size(); ++i)
+    {
+        if(!equalPatterns(x.d_children[i], y.d_children[i])) return false;
+    }
+    return true;
+}
+
+std::size_t patternSize(const Pattern& pattern)
+{
+    std::size_t size = 1;
+    const std::vector<Pattern>& children = pattern.node().d_children;
+    for(auto it = children.begin(); it != children.end(); ++it)
+    {
+        size += patternSize(*it);
+    }
+    return size;
+}
+
+Pattern flatten(const Pattern& pattern)
+{
+    Pattern mapped = mapChildren(pattern, flatten);
+    const Pattern::Node& node = mapped.node();
+    if(Pattern::Kind::SEQ != node.d_kind &&
+       Pattern::Kind::CHOICE != node.d_kind)
+    {
+        return mapped;
+    }
+    bool isSeq = Pattern::Kind::SEQ == node.d_kind;
+    std::vector<Pattern> spliced;
+    for(auto it = node.d_children.begin(); it != node.d_children.end();
+        ++it)
+    {
+        if(node.d_kind == it->node().d_kind)
+        {
+            const std::vector<Pattern>& inner = it->node().d_children;
+            spliced.insert(spliced.end(), inner.begin(), inner.end());
+        }
+        else if(!isSeq || !isEmptyLiteral(*it))
+        {
+            spliced.push_back(*it);
+        }
+    }
+    if(isSeq) return makeSeq(spliced);
+    return spliced.empty() ? mapped : makeChoice(spliced);
+}
+
+Pattern fuseLiterals(const Pattern& pattern)
+{
+    Pattern mapped = mapChildren(pattern, fuseLiterals);
+    if(Pattern::Kind::SEQ != mapped.node().d_kind) return mapped;
+    const std::vector<Pattern>& children = mapped.node().d_children;
+    std::vector<Pattern> fused;
+    for(auto it = children.begin(); it != children.end(); ++it)
+    {
+        if(isLiteral(*it) && !fused.empty() && isLiteral(fused.back()))
+        {
+            fused.back() = Pattern::literal(fused.back().node().d_text +
+                                            it->node().d_text);
+        }
+        else
+        {
+            fused.push_back(*it);
+        }
+    }
+    return makeSeq(fused);
+}
+
+Pattern leftFactor(const Pattern& pattern)
+{
+    Pattern mapped = mapChildren(pattern, leftFactor);
+    if(Pattern::Kind::CHOICE != mapped.node().d_kind) return mapped;
+    const std::vector<Pattern>& alternatives = mapped.node().d_children;
+
+    std::vector<Pattern> factored;
+    for(std::size_t i = 0; i < alternatives.size(); )
+    {
+        std::vector<Pattern> first = elements(alternatives[i]);
+        const Pattern& head = first[0];
+        std::size_t j = i + 1;
+        Pattern prefix = head;
+        if(isLiteral(head))
+        {
+            // literals sharing a prefix
+            std::string common = head.node().d_text;
+            for(; j < alternatives.size() && isPureTail(alternatives[j]);
+                ++j)
+            {
+                Pattern next = elements(alternatives[j])[0];
+                if(!isLiteral(next)) break;
+                std::size_t n = commonPrefix(common, next.node().d_text);
+                if(!n) break;
+                common.resize(n);
+            }
+            prefix = Pattern::literal(common);
+        }
+        else if(isPure(head))
+        {
+            // same first element
+            while(j < alternatives.size() &&
+                  isPureTail(alternatives[j]) &&
+                  equalPatterns(elements(alternatives[j])[0], head))
+            {
+                ++j;
+            }
+        }
+        if(j == i + 1)
+        {
+            factored.push_back(alternatives[i]);
+            ++i;
+            continue;
+        }
+
+        std::vector<Pattern> remainders;
+        for(std::size_t k = i; k < j; ++k)
+        {
+            std::vector<Pattern> rest = elements(alternatives[k]);
+            const Pattern::Node& front = rest[0].node();
+            std::size_t taken = prefix.node().d_text.size();
+            if(Pattern::Kind::LITERAL == prefix.node().d_kind &&
+               taken < front.d_text.size())
+            {
+                rest[0] = Pattern::literal(front.d_text.substr(taken));
+            }
+            else
+            {
+                rest.erase(rest.begin());
+            }
+            remainders.push_back(makeSeq(rest));
+        }
+        factored.push_back(
+            flatten(Pattern::seq({
+                        prefix,
+                        leftFactor(Pattern::choice(remainders))
+                    })));
+        i = j;
+    }
+    return makeChoice(factored);
+}
+
+Pattern mergeClasses(const Pattern& pattern)
+{
+    Pattern mapped = mapChildren(pattern, mergeClasses);
+    if(Pattern::Kind::CHOICE != mapped.node().d_kind) return mapped;
+    const std::vector<Pattern>& alternatives = mapped.node().d_children;
+    std::vector<Pattern> merged;
+    for(auto it = alternatives.begin(); it != alternatives.end(); ++it)
+    {
+        if(Pattern::Kind::CLASS == it->node().d_kind && !merged.empty() &&
+           Pattern::Kind::CLASS == merged.back().node().d_kind)
+        {
+            CharClass cls(merged.back().node().d_class);
+            cls.add(it->node().d_class);
+            merged.back() = Pattern::charset(cls);
+        }
+        else
+        {
+            merged.push_back(*it);
+        }
+    }
+    return makeChoice(merged);
+}
+
+PatternRules inlineRules(const PatternRules& rules, std::size_t maxSize)
+{
+    std::set<std::string> inlined;
+    for(auto it = rules.begin(); it != rules.end(); ++it)
+    {
+        std::set<std::string> visited;
+        if(patternSize(it->second) <= maxSize &&
+           !reaches(rules, it->second, it->first, visited))
+        {
+            inlined.insert(it->first);
+        }
+    }
+    PatternRules result;
+    for(auto it = rules.begin(); it != rules.end(); ++it)
+    {
+        result.insert(std::make_pair(
+                          it->first,
+                          substitute(it->second, rules, inlined)));
+    }
+    return result;
+}
+
+PatternRules optimize(const PatternRules& rules,
+                      const OptimizeOptions& options)
+{
+    PatternRules result =
+        options.d_inlineSize ? inlineRules(rules, options.d_inlineSize)
+                             : rules;
+    for(auto it = result.begin(); it != result.end(); ++it)
+    {
+        Pattern pattern = fuseLiterals(flatten(it->second));
+        pattern = fuseLiterals(flatten(leftFactor(pattern)));
+        it->second = mergeClasses(pattern);
+    }
+    return result;
+}
+
+} // close namespace yapeg
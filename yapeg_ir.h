@@ -0,0 +1,210 @@
+#ifndef INCLUDED_YAPEG_IR_H
+#define INCLUDED_YAPEG_IR_H
+
+// Optimization passes over Pattern grammars, and their lowering back to
+// Combinators Parsers.  A grammar is a map of rules; a RULE node naming
+// no rule of the map refers to a Parser bound at lowering, so opaque
+// parsers such as Scanners::keywords can still be leaves.  The passes
+// preserve what a grammar matches, its actors and the cache values they
+// see.  A choice rewritten by leftFactor may leave another value in the
+// cache when it is done, and the expected strings of failures may
+// differ.
+
+#include <yapeg_combinators.h>
+#include <yapeg_machine.h>
+#include <yapeg_scanners.h>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+using PatternRules = std::map<std::string, Pattern>;
+
+// Return true if 'a' and 'b' are the same tree.
+bool equalPatterns(const Pattern& a, const Pattern& b);
+
+// Return the number of nodes of 'pattern'.
+std::size_t patternSize(const Pattern& pattern);
+
+// Splice nested seq and choice nodes into their parent, drop empty
+// literals from sequences and replace one-element seq and choice nodes
+// by their element.
+Pattern flatten(const Pattern& pattern);
+
+// Replace adjacent literals of a sequence by one literal.  ch leaves
+// cache their character, so they are not fused.
+Pattern fuseLiterals(const Pattern& pattern);
+
+// Rewrite adjacent choice alternatives starting with the same element,
+// or with literals sharing a prefix, as one sequence of that prefix and
+// a choice of the remainders: 'a b / a c' becomes 'a (b / c)'.  Prefixes
+// holding actions or rule references are not factored, as they could
+// have effects that a second attempt repeats.  Nor are alternatives
+// whose remainder holds them: 'c' would see the cache left by a partial
+// match of 'b' instead of the one left by 'a'.
+Pattern leftFactor(const Pattern& pattern);
+
+// Replace adjacent class alternatives of a choice by one class, which
+// star and plus then scan at once.
+Pattern mergeClasses(const Pattern& pattern);
+
+// Replace references to non-recursive rules of at most 'maxSize' nodes
+// by the rule bodies.
+PatternRules inlineRules(const PatternRules& rules, std::size_t maxSize);
+
+struct OptimizeOptions
+{
+    std::size_t d_inlineSize;  // see inlineRules, 0 to not inline
+
+    OptimizeOptions()
+        : d_inlineSize(8) {}
+};
+
+// Run all the passes over 'rules'.
+PatternRules optimize(const PatternRules& rules,
+                      const OptimizeOptions& options = OptimizeOptions());
+
+// Conversion of Pattern grammars to Parsers.  class State must satisfy
+// the Scanners contract.
+template<typename State>
+struct Lowering
+{
+
+// TYPES
+using RCode = typename Combinators<State>::RCode;
+using Parser = typename Combinators<State>::Parser;
+using Actor = typename Combinators<State>::Actor;
+
+// Parsers and actors referred to by RULE and ACTION nodes.
+struct Bindings
+{
+    std::map<std::string, Parser> d_parsers;
+    std::map<std::string, Actor> d_actors;
+};
+
+// FUNCTIONS
+
+// Return the parser of 'rules' starting at 'start'.  Rules refer to each
+// other through one shared table, so each rule is built once and may be
+// recursive.  Throw std::invalid_argument if a referenced rule or actor
+// is neither in 'rules' nor bound.
+static Parser lower(const PatternRules& rules,
+                    const std::string& start,
+                    const Bindings& bindings)
+{
+    auto table = std::make_shared<std::map<std::string, Parser> >();
+    for(auto it = rules.begin(); it != rules.end(); ++it)
+    {
+        (*table)[it->first];
+    }
+    for(auto it = rules.begin(); it != rules.end(); ++it)
+    {
+        (*table)[it->first] = lower(it->second, *table, bindings);
+    }
+    auto found = table->find(start);
+    if(found == table->end())
+    {
+        throw std::invalid_argument("missing rule " + start);
+    }
+    // the rules refer to the table by address; the start parser owns it
+    const Parser* slot = &found->second;
+    return
+        [table, slot](State& state, bool must)->RCode
+        {
+            return (*slot)(state, must);
+        };
+}
+
+// Return the parser of 'pattern', whose RULE nodes must be bound.
+static Parser lower(const Pattern& pattern, const Bindings& bindings)
+{
+    std::map<std::string, Parser> table;
+    return lower(pattern, table, bindings);
+}
+
+private:
+static Parser lower(const Pattern& pattern,
+                    std::map<std::string, Parser>& table,
+                    const Bindings& bindings)
+{
+    using Cbnt = Combinators<State>;
+    using Scn = Scanners<State>;
+    const Pattern::Node& node = pattern.node();
+    std::vector<Parser> children;
+    for(auto it = node.d_children.begin(); it != node.d_children.end();
+        ++it)
+    {
+        children.push_back(lower(*it, table, bindings));
+    }
+    switch(node.d_kind)
+    {
+    case Pattern::Kind::CLASS:
+        return node.d_text.empty() ?
+            Scn::charset(node.d_class) : Scn::ch(node.d_text[0]);
+    case Pattern::Kind::ANY:
+        return Scn::any();
+    case Pattern::Kind::LITERAL:
+        if(node.d_text.empty())
+        {
+            return
+                [](State& state, bool must)->RCode
+                {
+                    return RCode::SUCCESS;
+                };
+        }
+        return Scn::literal(node.d_text);
+    case Pattern::Kind::SEQ:
+        return Cbnt::seq(children);
+    case Pattern::Kind::CHOICE:
+        return Cbnt::choice(children);
+    case Pattern::Kind::STAR:
+        return Scn::star(children[0]);
+    case Pattern::Kind::PLUS:
+        return Scn::plus(children[0]);
+    case Pattern::Kind::QMARK:
+        return Cbnt::qmark(children[0]);
+    case Pattern::Kind::PTEST:
+        return Cbnt::ptest(children[0]);
+    case Pattern::Kind::NTEST:
+        return Cbnt::ntest(children[0]);
+    case Pattern::Kind::ACTION:
+    {
+        auto actor = bindings.d_actors.find(node.d_text);
+        if(actor == bindings.d_actors.end())
+        {
+            throw std::invalid_argument("missing actor " + node.d_text);
+        }
+        return Cbnt::yaction(actor->second);
+    }
+    case Pattern::Kind::RULE:
+    {
+        auto rule = table.find(node.d_text);
+        if(rule != table.end())
+        {
+            const Parser* slot = &rule->second;
+            return
+                [slot](State& state, bool must)->RCode
+                {
+                    return (*slot)(state, must);
+                };
+        }
+        auto bound = bindings.d_parsers.find(node.d_text);
+        if(bound == bindings.d_parsers.end())
+        {
+            throw std::invalid_argument("missing rule " + node.d_text);
+        }
+        return bound->second;
+    }
+    }
+    return Parser();
+}
+
+}; // close struct Lowering
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_IR_H
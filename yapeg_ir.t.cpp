@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+#include <yapeg_ir.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <yapeg_scanners.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+namespace {
+
+using P = Pattern;
+using Lower = Lowering<BufferState>;
+using Cbnt = Combinators<BufferState>;
+
+// stmt <- 'select' ws '*' / 'select' ws ident / 'selected' / 'set' ws
+//         ident '=' num / 'update' ws ident
+// ident <- [a-z]+
+// num   <- [0-9]+ {number}
+// ws    <- ' '+
+PatternRules statementRules()
+{
+    P ws = P::rule("ws");
+    PatternRules rules;
+    rules.insert(std::make_pair(
+        "stmt",
+        P::choice({
+            P::seq({ P::literal("sel"), P::literal("ect"), ws, P::ch('*') }),
+            P::seq({ P::literal("select"), ws, P::rule("ident") }),
+            P::literal("selected"),
+            P::seq({
+                P::literal("set"), ws, P::rule("ident"), P::ch('='),
+                P::rule("num")
+            }),
+            P::seq({ P::literal("update"), ws, P::rule("ident") })
+        })));
+    rules.insert(std::make_pair("ident", P::plus(P::range('a', 'z'))));
+    rules.insert(std::make_pair(
+        "num",
+        P::seq({ P::plus(P::range('0', '9')), P::action("number") })));
+    rules.insert(std::make_pair("ws", P::plus(P::ch(' '))));
+    return rules;
+}
+
+} // close anonymous namespace
+
+TEST(Ir, flatten)
+{
+    P a = P::ch('a');
+    P b = P::ch('b');
+    P c = P::ch('c');
+    EXPECT_TRUE(equalPatterns(
+        flatten(P::seq({ P::seq({ a, P::literal("") }), P::seq({ b, c }) })),
+        P::seq({ a, b, c })));
+    EXPECT_TRUE(equalPatterns(
+        flatten(P::choice({ a, P::choice({ b, P::choice({ c }) }) })),
+        P::choice({ a, b, c })));
+    EXPECT_TRUE(equalPatterns(flatten(P::star(P::seq({ a }))), P::star(a)));
+    EXPECT_TRUE(equalPatterns(flatten(P::seq({ P::literal("") })),
+                              P::literal("")));
+    EXPECT_FALSE(equalPatterns(a, P::charset("a")));
+}
+
+TEST(Ir, fuseLiterals)
+{
+    EXPECT_TRUE(equalPatterns(
+        fuseLiterals(P::seq({
+                    P::literal("ab"), P::literal("cd"), P::ch('e'),
+                    P::literal("f"), P::literal("g")
+                })),
+        P::seq({ P::literal("abcd"), P::ch('e'), P::literal("fg") })));
+    EXPECT_TRUE(equalPatterns(
+        fuseLiterals(P::qmark(P::seq({ P::literal("a"), P::literal("b") }))),
+        P::qmark(P::literal("ab"))));
+}
+
+TEST(Ir, leftFactor)
+{
+    P x = P::ch('x');
+    P y = P::ch('y');
+    P z = P::ch('z');
+    EXPECT_TRUE(equalPatterns(
+        leftFactor(P::choice({ P::seq({ x, y }), P::seq({ x, z }), y })),
+        P::choice({ P::seq({ x, P::choice({ y, z }) }), y })));
+    EXPECT_TRUE(equalPatterns(
+        leftFactor(P::choice({
+                    P::literal("abc"), P::seq({ P::literal("abd"), x }),
+                    P::literal("b")
+                })),
+        P::choice({
+                P::seq({
+                    P::literal("ab"),
+                    P::choice({ P::literal("c"),
+                                P::seq({ P::literal("d"), x }) })
+                }),
+                P::literal("b")
+            })));
+
+    // alternatives that are not adjacent, or start with an action or a
+    // rule, are kept
+    P spaced = P::choice({ P::seq({ x, y }), z, P::seq({ x, z }) });
+    EXPECT_TRUE(equalPatterns(leftFactor(spaced), spaced));
+    P acting = P::choice({
+            P::seq({ P::action("f"), x }), P::seq({ P::action("f"), y })
+        });
+    EXPECT_TRUE(equalPatterns(leftFactor(acting), acting));
+    P ruled = P::choice({
+            P::seq({ P::rule("r"), x }), P::seq({ P::rule("r"), y })
+        });
+    EXPECT_TRUE(equalPatterns(leftFactor(ruled), ruled));
+
+    // nor alternatives after the first with an action or a rule in
+    // their remainder, which would see the cache of a partial match
+    P digit = P::range('0', '9');
+    P remainder = P::choice({
+            P::seq({ digit, P::range('a', 'z'), P::ch('q') }),
+            P::seq({ digit, P::action("act") })
+        });
+    EXPECT_TRUE(equalPatterns(leftFactor(remainder), remainder));
+    P first = P::choice({
+            P::seq({ x, P::action("f") }), P::seq({ x, y })
+        });
+    EXPECT_TRUE(equalPatterns(
+        leftFactor(first),
+        P::seq({ x, P::choice({ P::action("f"), y }) })));
+}
+
+TEST(Ir, mergeClasses)
+{
+    CharClass alnum('a', 'z');
+    alnum.add('0', '9');
+    EXPECT_TRUE(equalPatterns(
+        mergeClasses(P::plus(P::choice({
+                        P::range('a', 'z'), P::range('0', '9'),
+                        P::literal("__"), P::ch('$'), P::ch('%')
+                    }))),
+        P::plus(P::choice({
+                    P::charset(alnum), P::literal("__"), P::charset("$%")
+                }))));
+}
+
+TEST(Ir, inlineRules)
+{
+    PatternRules rules;
+    rules.insert(std::make_pair(
+        "list",
+        P::seq({ P::rule("item"),
+                 P::star(P::seq({ P::ch(','), P::rule("item") })) })));
+    rules.insert(std::make_pair(
+        "item",
+        P::choice({ P::rule("word"),
+                    P::seq({ P::ch('('), P::rule("list"), P::ch(')') }) })));
+    rules.insert(std::make_pair("word", P::plus(P::range('a', 'z'))));
+
+    PatternRules inlined = inlineRules(rules, 4);
+    // item is recursive through list, word is small
+    EXPECT_TRUE(equalPatterns(
+        inlined.at("item"),
+        P::choice({ P::plus(P::range('a', 'z')),
+                    P::seq({ P::ch('('), P::rule("list"), P::ch(')') }) })));
+    EXPECT_TRUE(equalPatterns(inlined.at("list"), rules.at("list")));
+
+    EXPECT_TRUE(equalPatterns(inlineRules(rules, 1).at("item"),
+                              rules.at("item")));
+}
+
+TEST(Ir, lower)
+{
+    std::vector<int> numbers;
+    Lower::Bindings bindings;
+    bindings.d_actors["number"] =
+        [&](BufferState& state) {
+            numbers.push_back(state.cache().get<char>() - '0');
+        };
+
+    PatternRules rules = statementRules();
+    PatternRules optimized = optimize(rules);
+    // 'sel...' / 'set ...' / 'update ...' after inlining ws, ident and
+    // num, whose action keeps 'set' out of the factored prefix
+    EXPECT_EQ(optimized.at("stmt").node().d_children.size(), 3u);
+    Cbnt::Parser plain = Lower::lower(rules, "stmt", bindings);
+    Cbnt::Parser fast = Lower::lower(optimized, "stmt", bindings);
+
+    const char* inputs[] = {
+        "select *", "select  abc", "selected", "select", "set a=7",
+        "set a=", "update x", "updat", "", "sel *"
+    };
+    for(const char* input : inputs)
+    {
+        std::string text(input);
+        numbers.clear();
+        BufferState slow(text);
+        Cbnt::RCode rc = plain(slow, false);
+        std::vector<int> slowNumbers = numbers;
+
+        numbers.clear();
+        BufferState state(text);
+        EXPECT_EQ(rc, fast(state, false)) << input;
+        EXPECT_EQ(slow.getPos(), state.getPos()) << input;
+        EXPECT_EQ(slowNumbers, numbers) << input;
+    }
+    EXPECT_EQ(numbers, std::vector<int>());
+    std::string text("set ab=3");
+    BufferState assignment(text);
+    EXPECT_EQ(Cbnt::RCode::SUCCESS, fast(assignment, false));
+    EXPECT_EQ(numbers, std::vector<int>({ 3 }));
+}
+
+TEST(Ir, leftFactorCache)
+{
+    // [0-9] [a-z] 'q' / [0-9] {act}: act sees the digit
+    P grammar = P::choice({
+            P::seq({ P::range('0', '9'), P::range('a', 'z'), P::ch('q') }),
+            P::seq({ P::range('0', '9'), P::action("act") })
+        });
+    std::string seen;
+    Lower::Bindings bindings;
+    bindings.d_actors["act"] =
+        [&seen](BufferState& s) { seen += s.cache().get<char>(); };
+    Cbnt::Parser parser = Lower::lower(leftFactor(grammar), bindings);
+    std::string text("5b!");
+    BufferState state(text);
+    EXPECT_EQ(Cbnt::RCode::SUCCESS, parser(state, false));
+    EXPECT_EQ(state.getPos(), 1u);
+    EXPECT_EQ(seen, "5");
+}
+
+TEST(Ir, lowerBindings)
+{
+    Lower::Bindings bindings;
+    bindings.d_parsers["digits"] =
+        Scanners<BufferState>::plus(Scanners<BufferState>::range('0', '9'));
+    Cbnt::Parser parser = Lower::lower(
+        P::seq({ P::ch('#'), P::rule("digits") }), bindings);
+    std::string text("#123");
+    BufferState state(text);
+    EXPECT_EQ(Cbnt::RCode::SUCCESS, parser(state, false));
+    EXPECT_EQ(state.getPos(), 4u);
+
+    EXPECT_THROW(Lower::lower(P::rule("nothing"), bindings),
+                 std::invalid_argument);
+    EXPECT_THROW(Lower::lower(P::action("nothing"), bindings),
+                 std::invalid_argument);
+    EXPECT_THROW(Lower::lower(statementRules(), "nothing", bindings),
+                 std::invalid_argument);
+}
+
+} // close namespace yapeg
@@ -0,0 +1,99 @@
+#include <yapeg_keywordtrie.h>
+#include <cassert>
+#include <map>
+
+namespace yapeg {
+
+// CREATORS
+KeywordTrie::KeywordTrie(const std::vector<std::string>& keywords)
+    : d_maxLength(0)
+{
+    // build a pointer trie, then lay it out breadth first
+    struct BuildNode
+    {
+        int d_id;
+        std::map<unsigned char, std::size_t> d_children;
+    };
+    std::vector<BuildNode> build(1, BuildNode{-1, {}});
+    for(std::size_t i = 0; i < keywords.size(); ++i)
+    {
+        const std::string& word = keywords[i];
+        assert(!word.empty());
+        std::size_t node = 0;
+        for(auto it = word.begin(); it != word.end(); ++it)
+        {
+            unsigned char c = static_cast<unsigned char>(*it);
+            auto child = build[node].d_children.find(c);
+            if(child == build[node].d_children.end())
+            {
+                build[node].d_children[c] = build.size();
+                node = build.size();
+                build.push_back(BuildNode{-1, {}});
+            }
+            else
+            {
+                node = child->second;
+            }
+        }
+        if(build[node].d_id < 0)
+        {
+            build[node].d_id = static_cast<int>(i);
+        }
+        if(word.size() > d_maxLength)
+        {
+            d_maxLength = word.size();
+        }
+    }
+
+    std::vector<std::uint32_t> index(build.size());
+    std::vector<std::size_t> order(1, 0);
+    for(std::size_t i = 0; i < order.size(); ++i)
+    {
+        index[order[i]] = static_cast<std::uint32_t>(i);
+        const auto& children = build[order[i]].d_children;
+        for(auto it = children.begin(); it != children.end(); ++it)
+        {
+            order.push_back(it->second);
+        }
+    }
+    for(std::size_t i = 0; i < order.size(); ++i)
+    {
+        const BuildNode& node = build[order[i]];
+        d_nodes.push_back(
+            Node{ node.d_id,
+                  static_cast<std::uint32_t>(d_edges.size()),
+                  static_cast<std::uint32_t>(node.d_children.size()) });
+        for(auto it = node.d_children.begin();
+            it != node.d_children.end();
+            ++it)
+        {
+            d_edges.push_back(Edge{ it->first, index[it->second] });
+        }
+    }
+}
+
+// ACCESSORS
+std::size_t KeywordTrie::match(const char* begin,
+                               const char* end,
+                               int& id) const
+{
+    std::size_t length = 0;
+    const Node* node = &d_nodes[0];
+    for(const char* p = begin; p != end; ++p)
+    {
+        unsigned char c = static_cast<unsigned char>(*p);
+        const Edge* edge = d_edges.data() + node->d_firstEdge;
+        const Edge* last = edge + node->d_numEdges;
+        while(edge != last && edge->d_label < c) ++edge;
+        if(edge == last || edge->d_label != c) break;
+        node = &d_nodes[edge->d_target];
+        if(node->d_id >= 0)
+        {
+            id = node->d_id;
+            length = static_cast<std::size_t>(p - begin) + 1;
+        }
+    }
+    return length;
+}
+    
+} // close namespace yapeg
@@ -0,0 +1,54 @@
+#ifndef INCLUDED_YAPEG_KEYWORDTRIE_H
+#define INCLUDED_YAPEG_KEYWORDTRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+// Immutable trie over a set of keywords, flattened into two arrays so a
+// lookup walks the input once regardless of how many keywords there are.
+// Keyword ids are their indices in the constructor argument.
+class KeywordTrie
+{
+private:
+    // TYPES
+    struct Node
+    {
+        int d_id;                  // keyword ending here, -1 if none
+        std::uint32_t d_firstEdge;
+        std::uint32_t d_numEdges;
+    };
+
+    struct Edge
+    {
+        unsigned char d_label;
+        std::uint32_t d_target;
+    };
+
+    // DATA
+    std::vector<Node> d_nodes;  // d_nodes[0] is the root
+    std::vector<Edge> d_edges;  // sorted by label per node
+    std::size_t d_maxLength;
+    
+public:
+    // CREATORS
+    explicit KeywordTrie(const std::vector<std::string>& keywords);
+
+    // ACCESSORS
+
+    // Return the length of the longest keyword that is a prefix of
+    // [begin, end) and load its id into 'id', or return 0.
+    std::size_t match(const char* begin, const char* end, int& id) const;
+
+    std::size_t maxLength() const
+    {
+        return d_maxLength;
+    }
+};
+    
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_KEYWORDTRIE_H
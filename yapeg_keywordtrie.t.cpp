@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <yapeg_keywordtrie.h>
+#include <string>
+
+namespace yapeg {
+
+namespace {
+
+std::size_t match(const KeywordTrie& trie, const std::string& text, int& id)
+{
+    return trie.match(text.data(), text.data() + text.size(), id);
+}
+    
+} // close anonymous namespace
+    
+TEST(KeywordTrie, match)
+{
+    KeywordTrie trie({ "in", "insert", "int", "into", "select", "in" });
+    EXPECT_EQ(trie.maxLength(), 6u);
+
+    int id = -1;
+    EXPECT_EQ(match(trie, "insert into", id), 6u);
+    EXPECT_EQ(id, 1);
+    EXPECT_EQ(match(trie, "inse", id), 2u);
+    EXPECT_EQ(id, 0);
+    EXPECT_EQ(match(trie, "integer", id), 3u);
+    EXPECT_EQ(id, 2);
+    EXPECT_EQ(match(trie, "into", id), 4u);
+    EXPECT_EQ(id, 3);
+    EXPECT_EQ(match(trie, "selec", id), 0u);
+    EXPECT_EQ(match(trie, "", id), 0u);
+    EXPECT_EQ(match(trie, "x", id), 0u);
+}
+
+TEST(KeywordTrie, empty)
+{
+    KeywordTrie trie({});
+    int id = -1;
+    EXPECT_EQ(match(trie, "abc", id), 0u);
+    EXPECT_EQ(id, -1);
+}
+    
+} // close namespace yapeg
@@ -0,0 +1,376 @@
+#include <yapeg_machine.h>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace yapeg {
+
+const std::size_t Program::k_NO_MATCH;
+
+// CLASS METHODS
+Pattern Pattern::make(Kind kind, const std::vector<Pattern>& children)
+{
+    auto node = std::make_shared<Node>();
+    node->d_kind = kind;
+    node->d_children = children;
+    return Pattern(node);
+}
+
+Pattern Pattern::ch(char c)
+{
+    auto node = std::make_shared<Node>();
+    node->d_kind = Kind::CLASS;
+    node->d_class = CharClass(c, c);
+    node->d_text = std::string(1, c);
+    return Pattern(node);
+}
+
+Pattern Pattern::range(char lo, char hi)
+{
+    return charset(CharClass(lo, hi));
+}
+
+Pattern Pattern::charset(const std::string& chars)
+{
+    return charset(CharClass(chars));
+}
+
+Pattern Pattern::charset(const CharClass& cls)
+{
+    auto node = std::make_shared<Node>();
+    node->d_kind = Kind::CLASS;
+    node->d_class = cls;
+    return Pattern(node);
+}
+
+Pattern Pattern::literal(const std::string& str)
+{
+    auto node = std::make_shared<Node>();
+    node->d_kind = Kind::LITERAL;
+    node->d_text = str;
+    return Pattern(node);
+}
+
+Pattern Pattern::any()
+{
+    return make(Kind::ANY);
+}
+
+Pattern Pattern::seq(const std::vector<Pattern>& patterns)
+{
+    return make(Kind::SEQ, patterns);
+}
+
+Pattern Pattern::choice(const std::vector<Pattern>& patterns)
+{
+    return make(Kind::CHOICE, patterns);
+}
+
+Pattern Pattern::star(const Pattern& pattern)
+{
+    return make(Kind::STAR, { pattern });
+}
+
+Pattern Pattern::plus(const Pattern& pattern)
+{
+    return make(Kind::PLUS, { pattern });
+}
+
+Pattern Pattern::qmark(const Pattern& pattern)
+{
+    return make(Kind::QMARK, { pattern });
+}
+
+Pattern Pattern::ptest(const Pattern& pattern)
+{
+    return make(Kind::PTEST, { pattern });
+}
+
+Pattern Pattern::ntest(const Pattern& pattern)
+{
+    return make(Kind::NTEST, { pattern });
+}
+
+Pattern Pattern::rule(const std::string& name)
+{
+    auto node = std::make_shared<Node>();
+    node->d_kind = Kind::RULE;
+    node->d_text = name;
+    return Pattern(node);
+}
+
+Pattern Pattern::action(const std::string& name)
+{
+    auto node = std::make_shared<Node>();
+    node->d_kind = Kind::ACTION;
+    node->d_text = name;
+    return Pattern(node);
+}
+
+// CREATORS
+Program::Program(const Pattern& pattern)
+{
+    std::vector<std::pair<std::size_t, std::string> > calls;
+    compile(pattern, calls);
+    emit(Op::END);
+    if(!calls.empty())
+    {
+        throw std::invalid_argument("no rule " + calls[0].second);
+    }
+}
+
+Program::Program(const std::map<std::string, Pattern>& rules,
+                 const std::string& start)
+{
+    std::vector<std::pair<std::size_t, std::string> > calls;
+    calls.push_back(std::make_pair(d_code.size(), start));
+    emit(Op::CALL);
+    emit(Op::END);
+    std::map<std::string, int> addresses;
+    for(auto it = rules.begin(); it != rules.end(); ++it)
+    {
+        addresses[it->first] = static_cast<int>(d_code.size());
+        compile(it->second, calls);
+        emit(Op::RETURN);
+    }
+    for(auto it = calls.begin(); it != calls.end(); ++it)
+    {
+        auto address = addresses.find(it->second);
+        if(address == addresses.end())
+        {
+            throw std::invalid_argument("no rule " + it->second);
+        }
+        d_code[it->first].d_arg = address->second;
+    }
+}
+
+// MANIPULATORS
+void Program::emit(Op op, int arg)
+{
+    d_code.push_back(Instruction{ op, arg });
+}
+
+void Program::compile(
+    const Pattern& pattern,
+    std::vector<std::pair<std::size_t, std::string> >& calls)
+{
+    const Pattern::Node& node = pattern.node();
+    const std::vector<Pattern>& children = node.d_children;
+    switch(node.d_kind)
+    {
+    case Pattern::Kind::CLASS:
+        if(1 == node.d_text.size())
+        {
+            emit(Op::CHAR, static_cast<unsigned char>(node.d_text[0]));
+        }
+        else
+        {
+            emit(Op::CLASS, static_cast<int>(d_classes.size()));
+            d_classes.push_back(node.d_class);
+        }
+        break;
+    case Pattern::Kind::ANY:
+        emit(Op::ANY);
+        break;
+    case Pattern::Kind::LITERAL:
+        if(!node.d_text.empty())
+        {
+            emit(Op::LITERAL, static_cast<int>(d_strings.size()));
+            d_strings.push_back(node.d_text);
+        }
+        break;
+    case Pattern::Kind::SEQ:
+        for(auto it = children.begin(); it != children.end(); ++it)
+        {
+            compile(*it, calls);
+        }
+        break;
+    case Pattern::Kind::CHOICE:
+    {
+        // CHOICE L1; p1; COMMIT end; L1: CHOICE L2; p2; ...; pn; end:
+        if(children.empty())
+        {
+            emit(Op::FAIL);
+            break;
+        }
+        std::vector<std::size_t> commits;
+        for(std::size_t i = 0; i + 1 < children.size(); ++i)
+        {
+            std::size_t choice = d_code.size();
+            emit(Op::CHOICE);
+            compile(children[i], calls);
+            commits.push_back(d_code.size());
+            emit(Op::COMMIT);
+            d_code[choice].d_arg = static_cast<int>(d_code.size());
+        }
+        compile(children.back(), calls);
+        for(auto it = commits.begin(); it != commits.end(); ++it)
+        {
+            d_code[*it].d_arg = static_cast<int>(d_code.size());
+        }
+        break;
+    }
+    case Pattern::Kind::PLUS:
+        compile(children[0], calls);
+        // fall through
+    case Pattern::Kind::STAR:
+    {
+        const Pattern::Node& child = children[0].node();
+        if(Pattern::Kind::CLASS == child.d_kind)
+        {
+            emit(Op::SPAN, static_cast<int>(d_classes.size()));
+            d_classes.push_back(child.d_class);
+            break;
+        }
+        // CHOICE end; body: p; PARTIAL_COMMIT body; end:
+        std::size_t choice = d_code.size();
+        emit(Op::CHOICE);
+        int body = static_cast<int>(d_code.size());
+        compile(children[0], calls);
+        emit(Op::PARTIAL_COMMIT, body);
+        d_code[choice].d_arg = static_cast<int>(d_code.size());
+        break;
+    }
+    case Pattern::Kind::QMARK:
+    {
+        std::size_t choice = d_code.size();
+        emit(Op::CHOICE);
+        compile(children[0], calls);
+        emit(Op::COMMIT, static_cast<int>(d_code.size()) + 1);
+        d_code[choice].d_arg = static_cast<int>(d_code.size());
+        break;
+    }
+    case Pattern::Kind::PTEST:
+    {
+        // CHOICE fail; p; BACK_COMMIT end; fail: FAIL; end:
+        std::size_t choice = d_code.size();
+        emit(Op::CHOICE);
+        compile(children[0], calls);
+        emit(Op::BACK_COMMIT, static_cast<int>(d_code.size()) + 2);
+        d_code[choice].d_arg = static_cast<int>(d_code.size());
+        emit(Op::FAIL);
+        break;
+    }
+    case Pattern::Kind::NTEST:
+    {
+        // CHOICE end; p; FAIL_TWICE; end:
+        std::size_t choice = d_code.size();
+        emit(Op::CHOICE);
+        compile(children[0], calls);
+        emit(Op::FAIL_TWICE);
+        d_code[choice].d_arg = static_cast<int>(d_code.size());
+        break;
+    }
+    case Pattern::Kind::RULE:
+        calls.push_back(std::make_pair(d_code.size(), node.d_text));
+        emit(Op::CALL);
+        break;
+    case Pattern::Kind::ACTION:
+        throw std::invalid_argument("action " + node.d_text +
+                                    " in a Program");
+    }
+}
+
+// ACCESSORS
+std::size_t Program::match(const char* begin, const char* end) const
+{
+    struct Entry
+    {
+        std::size_t d_pc;   // return address or alternative
+        const char* d_pos;  // position to restore, unless a call
+        bool d_call;
+    };
+    std::vector<Entry> stack;
+
+    const Instruction* code = d_code.data();
+    const char* p = begin;
+    std::size_t pc = 0;
+    while(true)
+    {
+        const Instruction& in = code[pc];
+        bool ok = true;
+        switch(in.d_op)
+        {
+        case Op::CHAR:
+            ok = p != end &&
+                static_cast<unsigned char>(*p) == in.d_arg;
+            if(ok) ++p, ++pc;
+            break;
+        case Op::CLASS:
+            ok = p != end && d_classes[in.d_arg].test(*p);
+            if(ok) ++p, ++pc;
+            break;
+        case Op::SPAN:
+            p += d_classes[in.d_arg].span(p, end);
+            ++pc;
+            break;
+        case Op::ANY:
+            ok = p != end;
+            if(ok) ++p, ++pc;
+            break;
+        case Op::LITERAL:
+        {
+            const std::string& s = d_strings[in.d_arg];
+            ok = static_cast<std::size_t>(end - p) >= s.size() &&
+                0 == std::memcmp(p, s.data(), s.size());
+            if(ok) p += s.size(), ++pc;
+            break;
+        }
+        case Op::JUMP:
+            pc = in.d_arg;
+            break;
+        case Op::CHOICE:
+            stack.push_back(Entry{ static_cast<std::size_t>(in.d_arg),
+                                   p, false });
+            ++pc;
+            break;
+        case Op::COMMIT:
+            stack.pop_back();
+            pc = in.d_arg;
+            break;
+        case Op::PARTIAL_COMMIT:
+            stack.back().d_pos = p;
+            pc = in.d_arg;
+            break;
+        case Op::BACK_COMMIT:
+            p = stack.back().d_pos;
+            stack.pop_back();
+            pc = in.d_arg;
+            break;
+        case Op::FAIL_TWICE:
+            stack.pop_back();
+            ok = false;
+            break;
+        case Op::FAIL:
+            ok = false;
+            break;
+        case Op::CALL:
+            stack.push_back(Entry{ pc + 1, nullptr, true });
+            pc = in.d_arg;
+            break;
+        case Op::RETURN:
+            assert(stack.back().d_call);
+            pc = stack.back().d_pc;
+            stack.pop_back();
+            break;
+        case Op::END:
+            return static_cast<std::size_t>(p - begin);
+        }
+        if(!ok)
+        {
+            while(!stack.empty() && stack.back().d_call)
+            {
+                stack.pop_back();
+            }
+            if(stack.empty())
+            {
+                return k_NO_MATCH;
+            }
+            p = stack.back().d_pos;
+            pc = stack.back().d_pc;
+            stack.pop_back();
+        }
+    }
+}
+
+} // close namespace yapeg
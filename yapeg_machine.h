@@ -0,0 +1,153 @@
+#ifndef INCLUDED_YAPEG_MACHINE_H
+#define INCLUDED_YAPEG_MACHINE_H
+
+#include <yapeg_charclass.h>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace yapeg {
+
+// Grammar tree built from the same operators as Combinators, compiled by
+// Program and by yapeg-gen (see yapeg_gen.h).  Patterns are immutable
+// and share their subtrees.
+class Pattern
+{
+public:
+    // TYPES
+    enum class Kind {
+        CLASS      // one character of d_class
+      , ANY        // any one character
+      , LITERAL    // d_text
+      , SEQ
+      , CHOICE
+      , STAR
+      , PLUS
+      , QMARK
+      , PTEST
+      , NTEST
+      , RULE       // reference to the rule named d_text
+      , ACTION     // call of the actor named d_text, for generated code
+    };
+
+    struct Node
+    {
+        Kind d_kind;
+        CharClass d_class;
+        std::string d_text;
+        std::vector<Pattern> d_children;
+    };
+
+private:
+    // DATA
+    std::shared_ptr<const Node> d_node;
+
+    // CREATORS
+    explicit Pattern(std::shared_ptr<const Node> node)
+        : d_node(std::move(node)) {}
+
+    static Pattern make(Kind kind,
+                        const std::vector<Pattern>& children = {});
+
+public:
+    // CLASS METHODS
+    static Pattern ch(char c);
+    static Pattern range(char lo, char hi);
+    static Pattern charset(const std::string& chars);
+    static Pattern charset(const CharClass& cls);
+    static Pattern literal(const std::string& str);
+    static Pattern any();
+    static Pattern seq(const std::vector<Pattern>& patterns);
+    static Pattern choice(const std::vector<Pattern>& patterns);
+    static Pattern star(const Pattern& pattern);
+    static Pattern plus(const Pattern& pattern);
+    static Pattern qmark(const Pattern& pattern);
+    static Pattern ptest(const Pattern& pattern);
+    static Pattern ntest(const Pattern& pattern);
+
+    // Refer to a rule of the Program, which may be recursive but not
+    // left-recursive.
+    static Pattern rule(const std::string& name);
+
+    // Call the actor 'name' and succeed; not supported by Program.
+    static Pattern action(const std::string& name);
+
+    // ACCESSORS
+    const Node& node() const { return *d_node; }
+};
+
+// A Pattern grammar compiled to a flat instruction array in the style of
+// LPeg's parsing machine, and run by one interpreter loop with an
+// explicit backtrack stack: there is no native call per operator, and
+// the nesting depth is bounded by the heap rather than the thread stack.
+// Programs only recognize; they do not run actors or touch a cache.
+class Program
+{
+public:
+    // TYPES
+    enum class Op {
+        CHAR            // match d_arg as a character
+      , CLASS           // match a character of class d_arg
+      , SPAN            // match a run of characters of class d_arg
+      , ANY
+      , LITERAL         // match string d_arg
+      , JUMP            // go to d_arg
+      , CHOICE          // push a backtrack entry resuming at d_arg
+      , COMMIT          // pop the backtrack entry and go to d_arg
+      , PARTIAL_COMMIT  // move the entry to here and go to d_arg
+      , BACK_COMMIT     // pop the entry, go back to it and to d_arg
+      , FAIL_TWICE      // pop the entry and fail
+      , FAIL
+      , CALL            // push the return address and go to d_arg
+      , RETURN
+      , END
+    };
+
+    struct Instruction
+    {
+        Op d_op;
+        int d_arg;
+    };
+
+    // CONSTANTS
+    static const std::size_t k_NO_MATCH = static_cast<std::size_t>(-1);
+
+private:
+    // DATA
+    std::vector<Instruction> d_code;
+    std::vector<CharClass> d_classes;
+    std::vector<std::string> d_strings;
+
+    // MANIPULATORS
+    void emit(Op op, int arg = 0);
+    void compile(const Pattern& pattern,
+                 std::vector<std::pair<std::size_t, std::string> >& calls);
+
+public:
+    // CREATORS
+
+    // Compile 'pattern'.  Throw std::invalid_argument if it refers to a
+    // rule or an action.
+    explicit Program(const Pattern& pattern);
+
+    // Compile the grammar 'rules' starting at the rule 'start'.  Throw
+    // std::invalid_argument if a referenced rule is missing or there is
+    // an action.
+    Program(const std::map<std::string, Pattern>& rules,
+            const std::string& start);
+
+    // ACCESSORS
+
+    // Return the end of the match of [begin, end) from 'begin', or
+    // k_NO_MATCH.
+    std::size_t match(const char* begin, const char* end) const;
+
+    const std::vector<Instruction>& code() const { return d_code; }
+};
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_MACHINE_H
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <yapeg_machine.h>
+#include <yapeg_scanners.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using Scn = Scanners<BufferState>;
+using P = Pattern;
+
+std::size_t match(const Program& program, const std::string& text)
+{
+    return program.match(text.data(), text.data() + text.size());
+}
+
+// expr <- term ('+' term)*
+// term <- [0-9]+ / '(' expr ')'
+std::map<std::string, Pattern> exprRules()
+{
+    std::map<std::string, Pattern> rules;
+    rules.insert(std::make_pair(
+        "expr",
+        P::seq({
+            P::rule("term"),
+            P::star(P::seq({ P::ch('+'), P::rule("term") }))
+        })));
+    rules.insert(std::make_pair(
+        "term",
+        P::choice({
+            P::plus(P::range('0', '9')),
+            P::seq({ P::ch('('), P::rule("expr"), P::ch(')') })
+        })));
+    return rules;
+}
+
+} // close anonymous namespace
+
+TEST(Program, leaves)
+{
+    Program program(
+        P::seq({
+            P::literal("ab"),
+            P::charset("xy"),
+            P::any(),
+            P::qmark(P::ch('!'))
+        }));
+    EXPECT_EQ(match(program, "abx?"), 4u);
+    EXPECT_EQ(match(program, "aby?!z"), 5u);
+    EXPECT_EQ(match(program, "abz?"), Program::k_NO_MATCH);
+    EXPECT_EQ(match(program, "abx"), Program::k_NO_MATCH);
+    EXPECT_EQ(match(program, "a"), Program::k_NO_MATCH);
+}
+
+TEST(Program, choice_star)
+{
+    Program program(
+        P::star(
+            P::choice({
+                P::literal("ab"),
+                P::literal("ac"),
+                P::plus(P::ch('x'))
+            })));
+    EXPECT_EQ(match(program, ""), 0u);
+    EXPECT_EQ(match(program, "abacxxab"), 8u);
+    EXPECT_EQ(match(program, "abad"), 2u);
+    EXPECT_EQ(Program(P::choice({})).code()[0].d_op, Program::Op::FAIL);
+}
+
+TEST(Program, ptest_ntest)
+{
+    // identifiers that are not keywords
+    Program program(
+        P::seq({
+            P::ntest(P::seq({ P::literal("if"),
+                              P::ntest(P::range('a', 'z')) })),
+            P::ptest(P::range('a', 'z')),
+            P::plus(P::range('a', 'z'))
+        }));
+    EXPECT_EQ(match(program, "iffy"), 4u);
+    EXPECT_EQ(match(program, "if"), Program::k_NO_MATCH);
+    EXPECT_EQ(match(program, "if x"), Program::k_NO_MATCH);
+    EXPECT_EQ(match(program, "x1"), 1u);
+    EXPECT_EQ(match(program, "1"), Program::k_NO_MATCH);
+}
+
+TEST(Program, rules)
+{
+    Program program(exprRules(), "expr");
+    EXPECT_EQ(match(program, "1+(2+3)+4"), 9u);
+    EXPECT_EQ(match(program, "1+(2+3"), 1u);
+    EXPECT_EQ(match(program, "+1"), Program::k_NO_MATCH);
+
+    // nesting is bounded by the heap, not the thread stack
+    std::string deep = std::string(100000, '(') + "1" +
+        std::string(100000, ')');
+    EXPECT_EQ(match(program, deep), deep.size());
+
+    EXPECT_THROW(Program(exprRules(), "nothing"), std::invalid_argument);
+    EXPECT_THROW(Program(P::rule("term")), std::invalid_argument);
+    EXPECT_THROW(Program(P::action("f")), std::invalid_argument);
+}
+
+TEST(Program, scanner)
+{
+    auto program = std::make_shared<const Program>(exprRules(), "expr");
+    Cbnt::Parser g =
+        Cbnt::seq({
+            Scn::ch('='),
+            Scn::program(program, "expression"),
+            Scn::ch(';')
+        });
+
+    std::string good("=1+(2);");
+    BufferState s1(good);
+    EXPECT_EQ(g(s1, true), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(s1.getPos(), good.size());
+
+    std::string bad("=(;");
+    BufferState s2(bad);
+    EXPECT_EQ(g(s2, false), Cbnt::RCode::FAIL);
+    EXPECT_EQ(s2.getPos(), 0u);
+    EXPECT_THROW(g(s2, true), ScanError);
+}
+
+} // close namespace yapeg
@@ -0,0 +1,111 @@
+#include <yapeg_bench.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// incremented by every thread that allocates
+std::atomic<std::size_t> g_allocations(0);
+
+std::vector<std::pair<std::string, yapeg::bench::Func> >& registry()
+{
+    static std::vector<std::pair<std::string, yapeg::bench::Func> > s_all;
+    return s_all;
+}
+
+double run(const yapeg::bench::Func& func,
+           yapeg::bench::Counters& total,
+           std::size_t& iterations,
+           std::size_t& allocs)
+{
+    using Clock = std::chrono::steady_clock;
+    const double minSeconds = 0.2;
+
+    yapeg::bench::Counters warmup = {0, 0, 0};
+    func(warmup);
+
+    total = yapeg::bench::Counters{0, 0, 0};
+    iterations = 0;
+    std::size_t allocStart = g_allocations.load(std::memory_order_relaxed);
+    Clock::time_point start = Clock::now();
+    double seconds = 0;
+    do
+    {
+        func(total);
+        ++iterations;
+        seconds =
+            std::chrono::duration<double>(Clock::now() - start).count();
+    } while(seconds < minSeconds);
+    allocs = g_allocations.load(std::memory_order_relaxed) - allocStart;
+    return seconds;
+}
+    
+} // close anonymous namespace
+
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace yapeg {
+namespace bench {
+
+void add(const std::string& name, const Func& func)
+{
+    registry().push_back(std::make_pair(name, func));
+}
+
+std::size_t allocations()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+    
+} // close namespace bench
+} // close namespace yapeg
+
+// Usage: yapeg_bench.tsk [name-prefix]
+int main(int argc, char* argv[])
+{
+    std::string filter = argc > 1 ? argv[1] : "";
+    for(const auto& entry: registry())
+    {
+        if(entry.first.compare(0, filter.size(), filter) != 0) continue;
+
+        yapeg::bench::Counters total;
+        std::size_t iterations;
+        std::size_t allocs;
+        double seconds = run(entry.second, total, iterations, allocs);
+        double ns = seconds * 1e9;
+
+        std::cout
+            << "{\"name\":\"" << entry.first << "\""
+            << ",\"iterations\":" << iterations
+            << ",\"ns_per_iter\":" << ns / iterations
+            << ",\"bytes_per_sec\":" << total.d_bytes / seconds
+            << ",\"items_per_sec\":" << total.d_items / seconds
+            << ",\"ns_per_call\":"
+            << (total.d_calls ? ns / total.d_calls : 0)
+            << ",\"allocs_per_iter\":"
+            << static_cast<double>(allocs) / iterations
+            << "}" << std::endl;
+    }
+    return 0;
+}
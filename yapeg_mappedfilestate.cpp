@@ -0,0 +1,97 @@
+#include <yapeg_mappedfilestate.h>
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace yapeg {
+
+namespace {
+
+std::system_error systemError(const std::string& what)
+{
+    return std::system_error(errno, std::generic_category(), what);
+}
+
+std::size_t pageSize()
+{
+    static const std::size_t s_size =
+        static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return s_size;
+}
+
+} // close anonymous namespace
+
+// CREATORS
+MappedFileState::MappedFileState(const std::string& path)
+    : d_begin("")
+    , d_size(0)
+    , d_pos(0)
+    , d_mapped(0)
+    , d_advised(0)
+    , d_dropped(0)
+    , d_failures(nullptr)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        throw systemError("open " + path);
+    }
+    struct stat st;
+    if(::fstat(fd, &st) < 0)
+    {
+        std::system_error error = systemError("fstat " + path);
+        ::close(fd);
+        throw error;
+    }
+    d_size = static_cast<std::size_t>(st.st_size);
+    if(d_size)
+    {
+        void* p = ::mmap(nullptr, d_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(MAP_FAILED == p)
+        {
+            std::system_error error = systemError("mmap " + path);
+            ::close(fd);
+            throw error;
+        }
+        d_begin = static_cast<const char*>(p);
+        d_mapped = d_size;
+        ::madvise(p, d_mapped, MADV_SEQUENTIAL);
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+MappedFileState::~MappedFileState()
+{
+    if(d_mapped)
+    {
+        ::munmap(const_cast<char*>(d_begin), d_mapped);
+    }
+}
+
+// MANIPULATORS
+void MappedFileState::follow()
+{
+    std::size_t page = pageSize();
+    char* base = const_cast<char*>(d_begin);
+
+    std::size_t start = d_pos / page * page;
+    d_advised = std::min<std::size_t>(d_pos + k_WINDOW, d_size);
+    ::madvise(base + start, d_advised - start, MADV_WILLNEED);
+
+    std::size_t keep = d_pins.empty() ? d_pos : d_pins.front();
+    keep = std::min(keep, d_pos) / page * page;
+    if(keep > d_dropped)
+    {
+        // pages of a private read-only mapping are re-read on access
+        ::madvise(base + d_dropped, keep - d_dropped, MADV_DONTNEED);
+        d_memo.eraseBefore(keep);
+        d_dropped = keep;
+    }
+}
+
+} // close namespace yapeg
@@ -0,0 +1,126 @@
+#ifndef INCLUDED_YAPEG_MAPPEDFILESTATE_H
+#define INCLUDED_YAPEG_MAPPEDFILESTATE_H
+
+#include <yapeg_any.h>
+#include <yapeg_failure.h>
+#include <yapeg_memo.h>
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+// State over a read-only memory mapping of a file, parsed in place with
+// no copy.  Positions are byte offsets from the beginning of the file.
+// The mapping is advised sequential; as the parse moves forward the
+// next window is advised needed, and pages before the oldest position a
+// pinned frame can rewind to are advised not needed, together with the
+// memo entries there.  Provides the character level interface used by
+// Scanners and the Pin interface of Combinators.
+class MappedFileState
+{
+public:
+    // CONSTANTS
+    enum { k_WINDOW = 1 << 20 };
+
+private:
+    // DATA
+    const char* d_begin;
+    std::size_t d_size;
+    std::size_t d_pos;
+    std::size_t d_mapped;             // mapping length, 0 if none
+    std::size_t d_advised;            // end of the window advised needed
+    std::size_t d_dropped;            // pages before are advised not needed
+    std::vector<std::size_t> d_pins;  // in stack order, oldest first
+    Any d_cache;
+    MemoTable<std::size_t> d_memo;
+    FarthestFailure* d_failures;      // not owned, null to throw
+
+    // MANIPULATORS
+
+    // Move the advised window to the current position.
+    void follow();
+
+public:
+    // CREATORS
+
+    // Map the file at 'path'; throw std::system_error on failure.
+    explicit MappedFileState(const std::string& path);
+    MappedFileState(const MappedFileState&) = delete;
+    MappedFileState& operator= (const MappedFileState&) = delete;
+    ~MappedFileState();
+
+    // MANIPULATORS
+    void setPos(std::size_t pos)
+    {
+        assert(pos <= d_size);
+        d_pos = pos;
+    }
+
+    void advance(std::size_t n)
+    {
+        assert(n <= d_size - d_pos);
+        d_pos += n;
+    }
+
+    // Return the number of bytes available at current(), which is at
+    // least 'n' unless the file ends first.
+    std::size_t fetch(std::size_t n)
+    {
+        if(d_advised < d_size &&
+           (d_pos >= d_advised || n > d_advised - d_pos))
+        {
+            follow();
+        }
+        return d_size - d_pos;
+    }
+
+    void pin(std::size_t pos)
+    {
+        d_pins.push_back(pos);
+    }
+
+    void unpin(std::size_t pos)
+    {
+        assert(!d_pins.empty() && d_pins.back() == pos);
+        d_pins.pop_back();
+    }
+
+    Any& cache() { return d_cache; }
+
+    MemoTable<std::size_t>& memoTable() { return d_memo; }
+
+    void trackFailures(FarthestFailure* failures)
+    {
+        d_failures = failures;
+    }
+
+    // ACCESSORS
+    std::size_t getPos() const
+    {
+        return d_pos;
+    }
+
+    const char* current() const
+    {
+        return d_begin + d_pos;
+    }
+
+    const Any& cache() const { return d_cache; }
+
+    FarthestFailure* failures() const { return d_failures; }
+
+    const char* begin() const { return d_begin; }
+
+    const char* end() const { return d_begin + d_size; }
+
+    std::size_t size() const
+    {
+        return d_size;
+    }
+};
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_MAPPEDFILESTATE_H
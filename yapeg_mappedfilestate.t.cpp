@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <yapeg_mappedfilestate.h>
+#include <yapeg_scanners.h>
+#include <yapeg_combinators.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<MappedFileState>;
+using Scn = Scanners<MappedFileState>;
+
+std::string writeFile(const std::string& name, const std::string& text)
+{
+    std::string path = ::testing::TempDir() + name;
+    std::ofstream out(path.c_str(), std::ios::binary);
+    out << text;
+    return path;
+}
+
+} // close anonymous namespace
+
+TEST(MappedFileState, positions)
+{
+    std::string path = writeFile("yapeg_mapped_positions", "hello");
+    MappedFileState state(path);
+    EXPECT_EQ(state.size(), 5u);
+    EXPECT_EQ(state.fetch(1), 5u);
+    EXPECT_EQ(*state.current(), 'h');
+
+    state.advance(4);
+    EXPECT_EQ(*state.current(), 'o');
+    state.setPos(1);
+    EXPECT_EQ(*state.current(), 'e');
+    state.setPos(5);
+    EXPECT_EQ(state.fetch(1), 0u);
+    std::remove(path.c_str());
+}
+
+TEST(MappedFileState, empty_missing)
+{
+    std::string path = writeFile("yapeg_mapped_empty", "");
+    MappedFileState state(path);
+    EXPECT_EQ(state.size(), 0u);
+    EXPECT_EQ(state.fetch(1), 0u);
+    std::remove(path.c_str());
+
+    EXPECT_THROW(MappedFileState missing(path), std::system_error);
+}
+
+TEST(MappedFileState, parse)
+{
+    std::string text;
+    for(int i = 0; i < 100000; ++i)
+    {
+        text += "entry_" + std::to_string(i) + " ";
+    }
+    std::string path = writeFile("yapeg_mapped_parse", text);
+    MappedFileState state(path);
+
+    CharClass ident('a', 'z');
+    ident.add('_').add('0', '9');
+    Cbnt::Parser grammar =
+        Cbnt::seq({
+            Cbnt::cut(),
+            Cbnt::star(
+                Cbnt::seq({
+                    Cbnt::memo(Scn::plus(Scn::charset(ident))),
+                    Scn::ch(' ')
+                })),
+            Cbnt::ntest(Scn::any())
+        });
+    EXPECT_EQ(grammar(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), text.size());
+    EXPECT_LT(state.memoTable().size(), 100000u);
+
+    // the whole file stays addressable
+    state.setPos(0);
+    EXPECT_EQ(Scn::literal("entry_0 ")(state, false), Cbnt::RCode::SUCCESS);
+    std::remove(path.c_str());
+}
+
+} // close namespace yapeg
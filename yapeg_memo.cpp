@@ -0,0 +1,12 @@
+#include <yapeg_memo.h>
+#include <atomic>
+
+namespace yapeg {
+
+std::size_t nextMemoRuleId()
+{
+    static std::atomic<std::size_t> s_next(0);
+    return s_next++;
+}
+    
+} // close namespace yapeg
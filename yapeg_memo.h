@@ -0,0 +1,128 @@
+#ifndef INCLUDED_YAPEG_MEMO_H
+#define INCLUDED_YAPEG_MEMO_H
+
+#include <yapeg_any.h>
+#include <yapeg_ast.h>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace yapeg {
+
+// Return a process-wide unique id for a memoized rule.
+std::size_t nextMemoRuleId();
+
+template<typename Pos, typename Value = Any>
+class MemoTable
+{
+public:
+    // TYPES
+    struct Entry
+    {
+        bool d_success;
+        Pos d_end;
+        Value d_value;
+        bool d_inProgress;  // rule is being evaluated at this position
+        bool d_leftRec;     // rule was re-entered while in progress
+        std::vector<Ast::Node> d_nodes;  // added on success, see Ast::subtrees
+    };
+    
+private:
+    // TYPES
+    struct Key
+    {
+        std::size_t d_rule;
+        Pos d_pos;
+
+        bool operator== (const Key& rhs) const
+        {
+            return d_rule == rhs.d_rule && d_pos == rhs.d_pos;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator() (const Key& key) const
+        {
+            return std::hash<Pos>()(key.d_pos) * 31u + key.d_rule;
+        }
+    };
+
+    // DATA
+    std::unordered_map<Key, Entry, KeyHash> d_entries;
+    std::vector<Key> d_heads;  // left-recursive rules growing a seed
+    
+public:
+    // MANIPULATORS
+    Entry* find(std::size_t rule, const Pos& pos)
+    {
+        auto it = d_entries.find(Key{rule, pos});
+        return it != d_entries.end() ? &it->second : nullptr;
+    }
+
+    Entry& insert(std::size_t rule, const Pos& pos)
+    {
+        return d_entries[Key{rule, pos}];
+    }
+
+    void erase(std::size_t rule, const Pos& pos)
+    {
+        d_entries.erase(Key{rule, pos});
+    }
+    
+    // Drop the entries at positions before 'pos', which a State that
+    // has released its input there can no longer rewind to.
+    void eraseBefore(const Pos& pos)
+    {
+        for(auto it = d_entries.begin(); it != d_entries.end(); )
+        {
+            if(it->first.d_pos < pos)
+            {
+                it = d_entries.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+    
+    void clear()
+    {
+        d_entries.clear();
+        d_heads.clear();
+    }
+
+    void pushHead(std::size_t rule, const Pos& pos)
+    {
+        d_heads.push_back(Key{rule, pos});
+    }
+
+    void popHead()
+    {
+        d_heads.pop_back();
+    }
+    
+    // ACCESSORS
+
+    // Return true if a rule other than 'rule' is growing a seed at
+    // 'pos', in which case entries of 'rule' at 'pos' may be stale.
+    bool isGrowing(std::size_t rule, const Pos& pos) const
+    {
+        for(auto it = d_heads.begin(); it != d_heads.end(); ++it)
+        {
+            if(it->d_pos == pos && it->d_rule != rule) return true;
+        }
+        return false;
+    }
+    
+    std::size_t size() const
+    {
+        return d_entries.size();
+    }
+};
+    
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_MEMO_H
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <yapeg_memo.h>
+#include <yapeg_any.h>
+
+namespace yapeg {
+
+TEST(MemoTable, nextMemoRuleId)
+{
+    std::size_t a = nextMemoRuleId();
+    std::size_t b = nextMemoRuleId();
+    EXPECT_NE(a, b);
+}
+    
+TEST(MemoTable, find_insert)
+{
+    MemoTable<std::size_t> table;
+    EXPECT_EQ(table.find(0, 3), nullptr);
+
+    auto& entry = table.insert(0, 3);
+    entry.d_success = true;
+    entry.d_end = 5;
+    entry.d_value.set<int>(7);
+
+    EXPECT_EQ(table.find(1, 3), nullptr);
+    EXPECT_EQ(table.find(0, 4), nullptr);
+    
+    auto* found = table.find(0, 3);
+    ASSERT_NE(found, nullptr);
+    EXPECT_TRUE(found->d_success);
+    EXPECT_EQ(found->d_end, 5u);
+    EXPECT_EQ(found->d_value.get<int>(), 7);
+    EXPECT_EQ(table.size(), 1u);
+
+    table.clear();
+    EXPECT_EQ(table.find(0, 3), nullptr);
+    EXPECT_EQ(table.size(), 0u);
+}
+    
+TEST(MemoTable, heads)
+{
+    MemoTable<std::size_t> table;
+    table.insert(0, 3);
+    table.erase(0, 3);
+    EXPECT_EQ(table.find(0, 3), nullptr);
+    
+    EXPECT_FALSE(table.isGrowing(1, 3));
+    table.pushHead(0, 3);
+    EXPECT_TRUE(table.isGrowing(1, 3));
+    EXPECT_FALSE(table.isGrowing(0, 3));
+    EXPECT_FALSE(table.isGrowing(1, 4));
+    table.popHead();
+    EXPECT_FALSE(table.isGrowing(1, 3));
+}
+
+TEST(MemoTable, eraseBefore)
+{
+    MemoTable<std::size_t> table;
+    table.insert(0, 1);
+    table.insert(1, 2);
+    table.insert(0, 3);
+
+    table.eraseBefore(3);
+    EXPECT_EQ(table.size(), 1u);
+    EXPECT_EQ(table.find(0, 1), nullptr);
+    EXPECT_EQ(table.find(1, 2), nullptr);
+    EXPECT_NE(table.find(0, 3), nullptr);
+}
+    
+} // close namespace yapeg
@@ -0,0 +1,60 @@
+#include <yapeg_parallel.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace yapeg {
+
+unsigned workerCount(unsigned threads)
+{
+    return
+        threads ?
+        threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+void parallelFor(
+    std::size_t numTasks,
+    unsigned workers,
+    const std::function<void (unsigned worker, std::size_t task)>& task)
+{
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto work =
+        [&](unsigned worker)
+        {
+            try
+            {
+                for(std::size_t i = next++; i < numTasks; i = next++)
+                {
+                    task(worker, i);
+                }
+            }
+            catch(...)
+            {
+                next = numTasks;
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if(!error) error = std::current_exception();
+            }
+        };
+
+    std::vector<std::thread> pool;
+    for(unsigned i = 1; i < workers && i < numTasks; ++i)
+    {
+        pool.push_back(std::thread(work, i));
+    }
+    work(0);
+    for(auto it = pool.begin(); it != pool.end(); ++it)
+    {
+        it->join();
+    }
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+} // close namespace yapeg
@@ -0,0 +1,24 @@
+#ifndef INCLUDED_YAPEG_PARALLEL_H
+#define INCLUDED_YAPEG_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace yapeg {
+
+// Return 'threads', or the hardware concurrency if it is 0.
+unsigned workerCount(unsigned threads);
+
+// Call 'task(worker, i)' for every i in [0, numTasks) on 'workers'
+// threads, the calling thread being worker 0.  Workers take the next
+// task as they finish one, so 'worker' identifies per-thread data that
+// tasks can reuse.  An exception thrown by a task stops the remaining
+// tasks and is rethrown once all threads have stopped.
+void parallelFor(
+    std::size_t numTasks,
+    unsigned workers,
+    const std::function<void (unsigned worker, std::size_t task)>& task);
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_PARALLEL_H
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <yapeg_parallel.h>
+#include <stdexcept>
+#include <vector>
+
+namespace yapeg {
+
+TEST(Parallel, parallelFor)
+{
+    EXPECT_EQ(workerCount(3), 3u);
+    EXPECT_GE(workerCount(0), 1u);
+
+    std::vector<int> done(100, 0);
+    parallelFor(
+        done.size(), 4,
+        [&](unsigned worker, std::size_t i)
+        {
+            ASSERT_LT(worker, 4u);
+            ++done[i];
+        });
+    for(std::size_t i = 0; i < done.size(); ++i)
+    {
+        EXPECT_EQ(done[i], 1);
+    }
+
+    parallelFor(0, 4, [](unsigned, std::size_t) { FAIL(); });
+    
+    EXPECT_THROW(
+        parallelFor(
+            100, 3,
+            [](unsigned, std::size_t i)
+            {
+                if(i == 10) throw std::runtime_error("task");
+            }),
+        std::runtime_error);
+}
+
+} // close namespace yapeg
@@ -0,0 +1,124 @@
+#include <yapeg_profile.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <ostream>
+
+namespace yapeg {
+
+namespace {
+
+thread_local Profiler* t_current = nullptr;
+
+double toMs(Profiler::Clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+} // close anonymous namespace
+
+// CREATORS
+Profiler::Activation::Activation(Profiler& profiler)
+    : d_previous(t_current)
+{
+    t_current = &profiler;
+}
+
+Profiler::Activation::~Activation()
+{
+    t_current = d_previous;
+}
+
+// CLASS METHODS
+Profiler* Profiler::current()
+{
+    return t_current;
+}
+
+std::size_t Profiler::nextRuleId()
+{
+    static std::atomic<std::size_t> s_next(0);
+    return s_next++;
+}
+
+// MANIPULATORS
+void Profiler::enter(std::size_t rule, const std::string& name)
+{
+    RuleStats& stats = d_rules[rule];
+    if(stats.d_name.empty())
+    {
+        stats.d_name = name;
+    }
+    ++stats.d_calls;
+    d_frames.push_back(Frame{ rule, Clock::now(), Clock::duration(0) });
+}
+
+void Profiler::leave(bool success, std::size_t consumed)
+{
+    assert(!d_frames.empty());
+    Frame frame = d_frames.back();
+    d_frames.pop_back();
+    Clock::duration elapsed = Clock::now() - frame.d_start;
+
+    RuleStats& stats = d_rules[frame.d_rule];
+    if(success)
+    {
+        ++stats.d_successes;
+        stats.d_consumed += consumed;
+    }
+    else
+    {
+        ++stats.d_failures;
+    }
+    stats.d_inclusive += elapsed;
+    stats.d_exclusive += elapsed - frame.d_children;
+    if(!d_frames.empty())
+    {
+        d_frames.back().d_children += elapsed;
+    }
+}
+
+void Profiler::clear()
+{
+    d_frames.clear();
+    d_rules.clear();
+}
+
+// ACCESSORS
+std::vector<Profiler::RuleStats> Profiler::stats() const
+{
+    std::vector<RuleStats> result;
+    for(auto it = d_rules.begin(); it != d_rules.end(); ++it)
+    {
+        result.push_back(it->second);
+    }
+    std::stable_sort(
+        result.begin(), result.end(),
+        [](const RuleStats& a, const RuleStats& b) {
+            return a.d_exclusive > b.d_exclusive;
+        });
+    return result;
+}
+
+void Profiler::report(std::ostream& out) const
+{
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "%-24s %10s %10s %10s %12s %12s %10s %10s\n",
+                  "rule", "calls", "success", "fail", "consumed",
+                  "rewound", "incl_ms", "excl_ms");
+    out << line;
+    std::vector<RuleStats> rules = stats();
+    for(auto it = rules.begin(); it != rules.end(); ++it)
+    {
+        std::snprintf(line, sizeof(line),
+                      "%-24s %10zu %10zu %10zu %12zu %12zu %10.3f %10.3f\n",
+                      it->d_name.c_str(), it->d_calls, it->d_successes,
+                      it->d_failures, it->d_consumed, it->d_rewound,
+                      toMs(it->d_inclusive), toMs(it->d_exclusive));
+        out << line;
+    }
+}
+
+} // close namespace yapeg
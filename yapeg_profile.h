@@ -0,0 +1,137 @@
+#ifndef INCLUDED_YAPEG_PROFILE_H
+#define INCLUDED_YAPEG_PROFILE_H
+
+// Per-rule counters for grammars built with Combinators::named.  The
+// counting is compiled in only when YAPEG_PROFILE is defined; otherwise
+// named returns its parser unchanged and a Profiler records nothing.
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace yapeg {
+
+class Profiler
+{
+public:
+    // TYPES
+    using Clock = std::chrono::steady_clock;
+
+    struct RuleStats
+    {
+        std::string d_name;
+        std::size_t d_calls;
+        std::size_t d_successes;
+        std::size_t d_failures;     // including exceptions
+        std::size_t d_consumed;     // positions consumed by successes
+        std::size_t d_rewound;      // positions rewound inside the rule
+        Clock::duration d_inclusive;
+        Clock::duration d_exclusive;  // minus the named rules it called
+    };
+
+    // Make a Profiler the one of the calling thread while in scope.
+    class Activation
+    {
+    private:
+        // DATA
+        Profiler* d_previous;
+
+    public:
+        // CREATORS
+        explicit Activation(Profiler& profiler);
+        ~Activation();
+        Activation(const Activation&) = delete;
+        Activation& operator= (const Activation&) = delete;
+    };
+
+    // One call of a named rule; a call not finished counts as a failure.
+    class Call
+    {
+    private:
+        // DATA
+        Profiler& d_profiler;
+        bool d_finished;
+
+    public:
+        // CREATORS
+        Call(Profiler& profiler, std::size_t rule, const std::string& name)
+            : d_profiler(profiler)
+            , d_finished(false)
+        {
+            d_profiler.enter(rule, name);
+        }
+        ~Call()
+        {
+            if(!d_finished) d_profiler.leave(false, 0);
+        }
+        Call(const Call&) = delete;
+        Call& operator= (const Call&) = delete;
+
+        // MANIPULATORS
+        void finish(bool success, std::size_t consumed)
+        {
+            d_finished = true;
+            d_profiler.leave(success, consumed);
+        }
+    };
+
+private:
+    // TYPES
+    struct Frame
+    {
+        std::size_t d_rule;
+        Clock::time_point d_start;
+        Clock::duration d_children;
+    };
+
+    // DATA
+    std::vector<Frame> d_frames;  // named rules being evaluated
+    std::unordered_map<std::size_t, RuleStats> d_rules;
+
+    // MANIPULATORS
+    void enter(std::size_t rule, const std::string& name);
+    void leave(bool success, std::size_t consumed);
+
+public:
+    // CLASS METHODS
+
+    // Return the profiler of the calling thread, or null.
+    static Profiler* current();
+
+    // Return a process-wide unique id for a named rule.
+    static std::size_t nextRuleId();
+
+    // CREATORS
+    Profiler() = default;
+    Profiler(const Profiler&) = delete;
+    Profiler& operator= (const Profiler&) = delete;
+
+    // MANIPULATORS
+
+    // Charge 'n' rewound positions to the innermost rule being evaluated.
+    void rewound(std::size_t n)
+    {
+        if(!d_frames.empty())
+        {
+            d_rules[d_frames.back().d_rule].d_rewound += n;
+        }
+    }
+
+    void clear();
+
+    // ACCESSORS
+
+    // Return the counters of every rule called, by decreasing exclusive
+    // time.
+    std::vector<RuleStats> stats() const;
+
+    // Print stats() as a table.
+    void report(std::ostream& out) const;
+};
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_PROFILE_H
@@ -0,0 +1,178 @@
+// Profiling is compiled in here only; every Combinators instantiation in
+// this file is on a State local to it.
+#ifndef YAPEG_PROFILE
+#define YAPEG_PROFILE
+#endif
+
+#include <gtest/gtest.h>
+#include <yapeg_profile.h>
+#include <yapeg_combinators.h>
+#include <yapeg_any.h>
+#include <yapeg_memo.h>
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace yapeg {
+
+namespace {
+
+class State
+{
+private:
+    // DATA
+    std::size_t d_pos;
+    std::string d_text;
+    Any d_cache;
+    MemoTable<std::size_t> d_memo;
+
+public:
+    // CREATORS
+    explicit State(const std::string& text)
+        : d_pos(0)
+        , d_text(text) {}
+
+    // MANIPULATORS
+    void setPos(std::size_t pos)
+    {
+        assert(pos <= d_text.size());
+        d_pos = pos;
+    }
+
+    Any& cache() { return d_cache; }
+
+    MemoTable<std::size_t>& memoTable() { return d_memo; }
+
+    // ACCESSORS
+    std::size_t getPos() const
+    {
+        return d_pos;
+    }
+
+    const std::string& text() const
+    {
+        return d_text;
+    }
+};
+
+using Cbnt = Combinators<State>;
+
+Cbnt::Parser ch(char c)
+{
+    return
+        [c](State& s, bool must)->Cbnt::RCode
+        {
+            if(s.getPos() < s.text().size() && s.text()[s.getPos()] == c)
+            {
+                s.setPos(s.getPos() + 1);
+                return Cbnt::RCode::SUCCESS;
+            }
+            if(must) throw std::runtime_error("unexpected");
+            return Cbnt::RCode::FAIL;
+        };
+}
+
+const Profiler::RuleStats& find(const std::vector<Profiler::RuleStats>& v,
+                                const std::string& name)
+{
+    for(auto it = v.begin(); it != v.end(); ++it)
+    {
+        if(it->d_name == name) return *it;
+    }
+    throw std::runtime_error("no rule " + name);
+}
+
+} // close anonymous namespace
+
+TEST(Profiler, named)
+{
+    Cbnt::Parser ab = Cbnt::named("ab", Cbnt::seq({ ch('a'), ch('b') }));
+    Cbnt::Parser ac = Cbnt::named("ac", Cbnt::seq({ ch('a'), ch('c') }));
+    Cbnt::Parser item =
+        Cbnt::named("item", Cbnt::choice({ ab, ac }));
+    Cbnt::Parser list = Cbnt::named("list", Cbnt::star(item));
+
+    State state("acabacx");
+    // not counted without an active profiler
+    EXPECT_EQ(list(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 6u);
+
+    Profiler profiler;
+    {
+        Profiler::Activation activation(profiler);
+        EXPECT_EQ(Profiler::current(), &profiler);
+        state.setPos(0);
+        EXPECT_EQ(list(state, false), Cbnt::RCode::SUCCESS);
+    }
+    EXPECT_EQ(Profiler::current(), nullptr);
+
+    std::vector<Profiler::RuleStats> stats = profiler.stats();
+    ASSERT_EQ(stats.size(), 4u);
+    const Profiler::RuleStats& sab = find(stats, "ab");
+    EXPECT_EQ(sab.d_calls, 4u);
+    EXPECT_EQ(sab.d_successes, 1u);
+    EXPECT_EQ(sab.d_failures, 3u);
+    EXPECT_EQ(sab.d_consumed, 2u);
+    EXPECT_EQ(sab.d_rewound, 2u);
+    const Profiler::RuleStats& sitem = find(stats, "item");
+    EXPECT_EQ(sitem.d_calls, 4u);
+    EXPECT_EQ(sitem.d_successes, 3u);
+    EXPECT_EQ(sitem.d_consumed, 6u);
+    EXPECT_EQ(sitem.d_rewound, 0u);
+    const Profiler::RuleStats& slist = find(stats, "list");
+    EXPECT_EQ(slist.d_calls, 1u);
+    EXPECT_EQ(slist.d_consumed, 6u);
+    EXPECT_GE(slist.d_inclusive, sitem.d_inclusive);
+    for(std::size_t i = 1; i < stats.size(); ++i)
+    {
+        EXPECT_GE(stats[i - 1].d_exclusive, stats[i].d_exclusive);
+    }
+
+    std::ostringstream out;
+    profiler.report(out);
+    EXPECT_NE(out.str().find("item"), std::string::npos);
+
+    profiler.clear();
+    EXPECT_TRUE(profiler.stats().empty());
+}
+
+TEST(Profiler, memoRewound)
+{
+    // expr <- expr '-' 'n' / 'n'
+    Cbnt::Rule expr;
+    expr.define(
+        Cbnt::named("expr",
+                    Cbnt::memo(Cbnt::choice({
+                                Cbnt::seq({ expr, ch('-'), ch('n') }),
+                                ch('n')
+                            }))));
+
+    State state("n-n-n");
+    Profiler profiler;
+    {
+        Profiler::Activation activation(profiler);
+        EXPECT_EQ(expr(state, false), Cbnt::RCode::SUCCESS);
+    }
+    expr.reset();
+    EXPECT_EQ(state.getPos(), 5u);
+
+    // each round of growing the seed goes back to 0 from the previous
+    // end (1, 3 then 5), and the last round's seq rewinds from 5
+    std::vector<Profiler::RuleStats> stats = profiler.stats();
+    const Profiler::RuleStats& sexpr = find(stats, "expr");
+    EXPECT_EQ(sexpr.d_rewound, 1u + 3u + 5u + 5u);
+}
+
+TEST(Profiler, exception)
+{
+    Cbnt::Parser p = Cbnt::named("p", ch('a'));
+    Profiler profiler;
+    Profiler::Activation activation(profiler);
+    State state("b");
+    EXPECT_THROW(p(state, true), std::runtime_error);
+    ASSERT_EQ(profiler.stats().size(), 1u);
+    EXPECT_EQ(profiler.stats()[0].d_failures, 1u);
+}
+
+} // close namespace yapeg
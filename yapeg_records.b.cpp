@@ -0,0 +1,52 @@
+#include <yapeg_bench.h>
+#include <yapeg_records.h>
+#include <yapeg_scanners.h>
+#include <yapeg_combinators.h>
+#include <cassert>
+#include <string>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using Scn = Scanners<BufferState>;
+
+void benchRecords(bench::Counters& counters, unsigned threads)
+{
+    static std::string input;
+    if(input.empty())
+    {
+        for(int i = 0; i < 20000; ++i)
+        {
+            input += "request_handler_" + std::to_string(i) +
+                " status ok latency_ms " + std::to_string(i % 97) + "\n";
+        }
+    }
+    CharClass ident('a', 'z');
+    ident.add('_').add('0', '9');
+    static const Cbnt::Parser record =
+        Cbnt::star(
+            Cbnt::seq({
+                Scn::plus(Scn::charset(ident)),
+                Scn::star(Scn::ch(' '))
+            }));
+
+    std::vector<Record> records =
+        parseRecords(input.data(), input.data() + input.size(),
+                     delimitedRecords('\n'), record, threads);
+    assert(records.size() == 20000);
+    bench::keep(records);
+    counters.d_bytes += input.size();
+    counters.d_items += records.size();
+}
+bench::Registrar s_records1(
+    "records/threads_1",
+    [](bench::Counters& c) { benchRecords(c, 1); });
+bench::Registrar s_recordsAll(
+    "records/threads_all",
+    [](bench::Counters& c) { benchRecords(c, 0); });
+
+} // close anonymous namespace
+
+} // close namespace yapeg
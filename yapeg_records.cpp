@@ -0,0 +1,99 @@
+#include <yapeg_records.h>
+#include <yapeg_parallel.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+namespace yapeg {
+
+namespace {
+
+// Chunks per thread, so that a slow chunk does not leave others idle.
+const std::size_t k_CHUNKS_PER_THREAD = 4;
+
+void parseChunk(const char* begin,
+                const char* chunkBegin,
+                const char* chunkEnd,
+                const RecordBoundary& boundary,
+                const Combinators<BufferState>::Parser& parser,
+                BufferState& state,
+                std::vector<Record>& records)
+{
+    using RCode = Combinators<BufferState>::RCode;
+    for(const char* p = chunkBegin; p != chunkEnd; )
+    {
+        const char* q = boundary(p, chunkEnd);
+        if(q == p) q = chunkEnd;
+        state.reset(p, q);
+        Record record;
+        record.d_begin = static_cast<std::size_t>(p - begin);
+        record.d_end = static_cast<std::size_t>(q - begin);
+        record.d_success = RCode::SUCCESS == parser(state, false);
+        if(record.d_success)
+        {
+            record.d_value = std::move(state.cache());
+        }
+        records.push_back(std::move(record));
+        p = q;
+    }
+}
+
+} // close anonymous namespace
+
+RecordBoundary delimitedRecords(char delimiter)
+{
+    return
+        [delimiter](const char* p, const char* end)->const char*
+        {
+            const void* d = std::memchr(p, delimiter, end - p);
+            return d ? static_cast<const char*>(d) + 1 : end;
+        };
+}
+
+std::vector<Record> parseRecords(
+    const char* begin,
+    const char* end,
+    const RecordBoundary& boundary,
+    const Combinators<BufferState>::Parser& parser,
+    unsigned threads)
+{
+    threads = workerCount(threads);
+
+    // chunk starts, snapped forward to record starts
+    std::size_t size = static_cast<std::size_t>(end - begin);
+    std::size_t numChunks = threads * k_CHUNKS_PER_THREAD;
+    std::vector<const char*> starts(1, begin);
+    for(std::size_t i = 1; i < numChunks; ++i)
+    {
+        const char* p = begin + size / numChunks * i;
+        if(p <= starts.back()) continue;
+        p = boundary(p, end);
+        if(p != end && p > starts.back()) starts.push_back(p);
+    }
+    starts.push_back(end);
+    numChunks = starts.size() - 1;
+
+    std::vector<std::vector<Record> > chunks(numChunks);
+    std::vector<std::unique_ptr<BufferState> > states(threads);
+    parallelFor(
+        numChunks, threads,
+        [&](unsigned worker, std::size_t i)
+        {
+            if(!states[worker])
+            {
+                states[worker].reset(new BufferState(begin, begin));
+            }
+            parseChunk(begin, starts[i], starts[i + 1],
+                       boundary, parser, *states[worker], chunks[i]);
+        });
+
+    std::vector<Record> records;
+    for(auto it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        std::move(it->begin(), it->end(), std::back_inserter(records));
+    }
+    return records;
+}
+
+} // close namespace yapeg
@@ -0,0 +1,49 @@
+#ifndef INCLUDED_YAPEG_RECORDS_H
+#define INCLUDED_YAPEG_RECORDS_H
+
+#include <yapeg_any.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace yapeg {
+
+// One record found by parseRecords.
+struct Record
+{
+    std::size_t d_begin;  // byte offsets of the record in the input
+    std::size_t d_end;
+    bool d_success;       // the record parser succeeded
+    Any d_value;          // cache value it left, if it succeeded
+};
+
+// Return the end of the record starting at or containing 'p', which is
+// the start of the next record, or 'end'.  It is called on arbitrary
+// positions to split the input, so it must find a boundary without
+// context (e.g. the byte after the next newline).
+using RecordBoundary =
+    std::function<const char* (const char* p, const char* end)>;
+
+// Boundary after the next 'delimiter'.
+RecordBoundary delimitedRecords(char delimiter);
+
+// Split [begin, end) into records with 'boundary' and parse each one on
+// its own BufferState with 'parser', not requiring the parser to consume
+// the whole record.  The input is cut into chunks aligned to record
+// boundaries and the chunks are parsed on 'threads' threads (the
+// hardware concurrency if 0), each reusing one BufferState.  'parser'
+// is called from all threads at once and must not modify shared state.
+// Return the records in input order.  An exception thrown by 'parser'
+// is rethrown once all threads have stopped.
+std::vector<Record> parseRecords(
+    const char* begin,
+    const char* end,
+    const RecordBoundary& boundary,
+    const Combinators<BufferState>::Parser& parser,
+    unsigned threads = 0);
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_RECORDS_H
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <yapeg_records.h>
+#include <yapeg_scanners.h>
+#include <yapeg_combinators.h>
+#include <stdexcept>
+#include <string>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using Scn = Scanners<BufferState>;
+
+// "name=digits\n", caching the record length.
+Cbnt::Parser recordParser()
+{
+    return
+        Cbnt::seq({
+            Scn::plus(Scn::range('a', 'z')),
+            Scn::ch('='),
+            Scn::plus(Scn::range('0', '9')),
+            Scn::ch('\n'),
+            Cbnt::yaction(
+                [](BufferState& s) {
+                    s.cache().set(static_cast<int>(s.getPos()));
+                })
+        });
+}
+
+} // close anonymous namespace
+
+TEST(Records, delimitedRecords)
+{
+    std::string text("ab\ncd");
+    RecordBoundary boundary = delimitedRecords('\n');
+    const char* end = text.data() + text.size();
+    EXPECT_EQ(boundary(text.data(), end), text.data() + 3);
+    EXPECT_EQ(boundary(text.data() + 3, end), end);
+}
+
+TEST(Records, parseRecords)
+{
+    std::string text;
+    for(int i = 0; i < 1000; ++i)
+    {
+        text += i % 100 == 7 ? "bad\n" : "k=" + std::to_string(i) + "\n";
+    }
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+
+    for(unsigned threads = 1; threads <= 4; ++threads)
+    {
+        std::vector<Record> records =
+            parseRecords(begin, end, delimitedRecords('\n'),
+                         recordParser(), threads);
+        ASSERT_EQ(records.size(), 1000u);
+        std::size_t pos = 0;
+        for(int i = 0; i < 1000; ++i)
+        {
+            const Record& r = records[i];
+            EXPECT_EQ(r.d_begin, pos);
+            pos = r.d_end;
+            EXPECT_EQ(r.d_success, i % 100 != 7);
+            if(r.d_success)
+            {
+                EXPECT_EQ(r.d_value.get<int>(),
+                          static_cast<int>(r.d_end - r.d_begin));
+            }
+        }
+        EXPECT_EQ(pos, text.size());
+    }
+
+    EXPECT_TRUE(parseRecords(begin, begin, delimitedRecords('\n'),
+                             recordParser(), 2).empty());
+}
+
+TEST(Records, exception)
+{
+    std::string text("a=1\nb=2\nc=x\nd=4\n");
+    Cbnt::Parser must =
+        [](BufferState& s, bool) { return recordParser()(s, true); };
+    EXPECT_THROW(
+        parseRecords(text.data(), text.data() + text.size(),
+                     delimitedRecords('\n'), must, 2),
+        ScanError);
+}
+
+} // close namespace yapeg
@@ -0,0 +1,229 @@
+#include <yapeg_bench.h>
+#include <yapeg_scanners.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <yapeg_failure.h>
+#include <yapeg_machine.h>
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <vector>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using Scn = Scanners<BufferState>;
+
+// Log lines of whitespace separated identifiers and numbers.
+std::string logInput()
+{
+    std::string text;
+    for(int i = 0; i < 5000; ++i)
+    {
+        text += "2024 request_handler_" + std::to_string(i) +
+            "    status     ok   latency_ms " + std::to_string(i % 97) +
+            "\t\tuser_agent_string_with_a_long_name\n";
+    }
+    return text;
+}
+    
+Cbnt::Parser logGrammar(bool vectorized)
+{
+    auto star = vectorized ? &Scn::star : &Cbnt::star;
+    auto plus = vectorized ? &Scn::plus : &Cbnt::plus;
+    CharClass identHead('a', 'z');
+    identHead.add('A', 'Z').add('_');
+    CharClass identTail(identHead);
+    identTail.add('0', '9');
+    Cbnt::Parser ws = star(Scn::charset(" \t\n"));
+    Cbnt::Parser word =
+        Cbnt::choice({
+            Cbnt::seq({
+                Scn::charset(identHead),
+                star(Scn::charset(identTail))
+            }),
+            plus(Scn::range('0', '9'))
+        });
+    return Cbnt::star(Cbnt::seq({ ws, word }));
+}
+
+void benchLog(bench::Counters& counters, bool vectorized)
+{
+    static const std::string input = logInput();
+    static const Cbnt::Parser scalar = logGrammar(false);
+    static const Cbnt::Parser vector = logGrammar(true);
+
+    BufferState state(input);
+    (vectorized ? vector : scalar)(state, false);
+    assert(state.getPos() == input.size());
+    counters.d_bytes += input.size();
+    counters.d_items += 5000;
+}
+bench::Registrar s_log(
+    "scanners/log",
+    [](bench::Counters& c) { benchLog(c, false); });
+bench::Registrar s_logVectorized(
+    "scanners/log_span",
+    [](bench::Counters& c) { benchLog(c, true); });
+
+void benchLogMachine(bench::Counters& counters)
+{
+    static const std::string input = logInput();
+    static const Cbnt::Parser grammar =
+        []() {
+            using P = Pattern;
+            CharClass identHead('a', 'z');
+            identHead.add('A', 'Z').add('_');
+            CharClass identTail(identHead);
+            identTail.add('0', '9');
+            P word =
+                P::choice({
+                    P::seq({
+                        P::charset(identHead),
+                        P::star(P::charset(identTail))
+                    }),
+                    P::plus(P::range('0', '9'))
+                });
+            P log =
+                P::star(P::seq({ P::star(P::charset(" \t\n")), word }));
+            return
+                Scn::program(std::make_shared<const Program>(log), "log");
+        }();
+
+    BufferState state(input);
+    grammar(state, false);
+    assert(state.getPos() == input.size());
+    counters.d_bytes += input.size();
+    counters.d_items += 5000;
+}
+bench::Registrar s_logMachine("scanners/log_machine", &benchLogMachine);
+
+std::vector<std::string> keywordList()
+{
+    std::vector<std::string> words;
+    const char* stems[] = { "select", "insert", "update", "delete", "create",
+                            "alter", "drop", "grant", "revoke", "index" };
+    for(int i = 0; i < 200; ++i)
+    {
+        words.push_back(stems[i % 10] + std::string("_") + std::to_string(i));
+    }
+    return words;
+}
+    
+void benchKeywords(bench::Counters& counters, bool trie)
+{
+    static const std::vector<std::string> words = keywordList();
+    static std::string input;
+    if(input.empty())
+    {
+        for(int i = 0; i < 2000; ++i)
+        {
+            input += words[(i * 37) % words.size()] + " ";
+        }
+    }
+    static Cbnt::Parser choice;
+    if(!choice)
+    {
+        // longest first, so that a prefix does not shadow a keyword
+        std::vector<std::string> sorted(words);
+        std::stable_sort(
+            sorted.begin(), sorted.end(),
+            [](const std::string& a, const std::string& b) {
+                return a.size() > b.size();
+            });
+        std::vector<Cbnt::Parser> literals;
+        for(const auto& word: sorted)
+        {
+            literals.push_back(
+                Cbnt::combo(
+                    Scn::literal(word),
+                    [](BufferState& s) { s.cache().set(0); }));
+        }
+        choice = Cbnt::choice(literals);
+    }
+    static const Cbnt::Parser keywords = Scn::keywords(words);
+    static const Cbnt::Parser choiceGrammar =
+        Cbnt::star(Cbnt::seq({ choice, Scn::ch(' ') }));
+    static const Cbnt::Parser trieGrammar =
+        Cbnt::star(Cbnt::seq({ keywords, Scn::ch(' ') }));
+
+    BufferState state(input);
+    (trie ? trieGrammar : choiceGrammar)(state, false);
+    assert(state.getPos() == input.size());
+    counters.d_bytes += input.size();
+    counters.d_items += 2000;
+}
+bench::Registrar s_keywordChoice(
+    "scanners/keywords_choice",
+    [](bench::Counters& c) { benchKeywords(c, false); });
+bench::Registrar s_keywordTrie(
+    "scanners/keywords_trie",
+    [](bench::Counters& c) { benchKeywords(c, true); });
+    
+void benchMalformed(bench::Counters& counters, bool tracked)
+{
+    static const std::string input("key = maybe;");
+    static const Cbnt::Parser grammar =
+        Cbnt::seq({
+            Scn::plus(Scn::range('a', 'z')),
+            Cbnt::cut(),
+            Scn::star(Scn::ch(' ')),
+            Scn::ch('='),
+            Scn::star(Scn::ch(' ')),
+            Cbnt::choice({
+                Scn::plus(Scn::range('0', '9')),
+                Scn::literal("true"),
+                Scn::literal("false")
+            }),
+            Scn::ch(';')
+        });
+
+    BufferState state(input);
+    FarthestFailure failure;
+    for(int i = 0; i < 100; ++i)
+    {
+        state.reset(input);
+        if(tracked)
+        {
+            bool ok = parseTracked(grammar, state, failure);
+            assert(!ok && failure.pos() == 6);
+            bench::keep(ok);
+        }
+        else
+        {
+            try
+            {
+                grammar(state, false);
+                assert(false);
+            }
+            catch(const ScanError& e)
+            {
+                bench::keep(e.pos());
+            }
+        }
+    }
+    counters.d_bytes += 100 * input.size();
+    counters.d_items += 100;
+}
+bench::Registrar s_malformedThrow(
+    "scanners/malformed_throw",
+    [](bench::Counters& c) { benchMalformed(c, false); });
+bench::Registrar s_malformedTracked(
+    "scanners/malformed_tracked",
+    [](bench::Counters& c) { benchMalformed(c, true); });
+
+void benchSpan(bench::Counters& counters)
+{
+    static const std::string input = std::string(1 << 16, ' ') + "x";
+    static const CharClass ws(" \t\r\n");
+    std::size_t n = ws.span(input.data(), input.data() + input.size());
+    bench::keep(n);
+    counters.d_bytes += n;
+}
+bench::Registrar s_span("scanners/charclass_span", &benchSpan);
+    
+} // close anonymous namespace
+    
+} // close namespace yapeg
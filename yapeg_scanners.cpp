@@ -0,0 +1,14 @@
+#include <yapeg_scanners.h>
+
+namespace yapeg {
+
+// CREATORS
+ScanError::ScanError(std::size_t pos, const std::string& expected)
+    : std::runtime_error(
+        "expected " + expected + " at " + std::to_string(pos))
+    , d_pos(pos)
+    , d_expected(expected)
+{
+}
+    
+} // close namespace yapeg
@@ -0,0 +1,308 @@
+#ifndef INCLUDED_YAPEG_SCANNERS_H
+#define INCLUDED_YAPEG_SCANNERS_H
+
+#include <yapeg_combinators.h>
+#include <yapeg_charclass.h>
+#include <yapeg_failure.h>
+#include <yapeg_keywordtrie.h>
+#include <yapeg_machine.h>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace yapeg {
+
+namespace scanners_impl {
+
+template<typename State, typename = void>
+struct HasFailures: public std::false_type {};
+template<typename State>
+struct HasFailures<
+    State,
+    decltype(std::declval<State&>().failures(), void())>
+    : public std::true_type {};
+
+} // close namespace scanners_impl
+
+// Thrown by Scanners parsers that fail when 'must' is true.
+class ScanError: public std::runtime_error
+{
+private:
+    // DATA
+    std::size_t d_pos;
+    std::string d_expected;
+
+public:
+    // CREATORS
+    ScanError(std::size_t pos, const std::string& expected);
+
+    // ACCESSORS
+    std::size_t pos() const { return d_pos; }
+    const std::string& expected() const { return d_expected; }
+};
+    
+// Scannerless leaf parsers matching bytes directly.
+template<typename State>
+struct Scanners
+{
+
+// class State must have, in addition to the Combinators contract with
+// std::size_t positions,
+//   - std::size_t fetch(std::size_t n)
+//       make up to 'n' bytes available at current() and return how many
+//       are, 0 at the end of input
+//   - const char* current()
+//   - void advance(std::size_t n)
+// and optionally, to record failures instead of throwing them,
+//   - FarthestFailure* failures()
+//       return the recorder set by parseTracked, or null
+    
+// TYPES
+using RCode = typename Combinators<State>::RCode;
+using Parser = typename Combinators<State>::Parser;
+
+// CONSTANTS
+enum { k_SPAN_CHUNK = 4096 };
+
+// FUNCTIONS
+
+// Leaf parser matching one character of a CharClass and caching it.
+// Scanners::star and plus recognize it and scan a whole run at once.
+class ClassParser
+{
+private:
+    // DATA
+    CharClass d_class;
+    std::string d_expected;
+
+public:
+    // CREATORS
+    ClassParser(const CharClass& cls, const std::string& expected)
+        : d_class(cls)
+        , d_expected(expected) {}
+
+    // ACCESSORS
+    RCode operator() (State& state, bool must) const
+    {
+        if(state.fetch(1))
+        {
+            char c = *state.current();
+            if(d_class.test(c))
+            {
+                state.cache().set(c);
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+        }
+        return fail(state, must, d_expected);
+    }
+
+    // Consume the longest run of characters in the class, caching the
+    // last one, and return its length.
+    std::size_t span(State& state) const
+    {
+        std::size_t total = 0;
+        while(std::size_t n = state.fetch(k_SPAN_CHUNK))
+        {
+            const char* p = state.current();
+            std::size_t m = d_class.span(p, p + n);
+            if(m)
+            {
+                state.cache().set(p[m - 1]);
+                state.advance(m);
+                total += m;
+            }
+            if(m < n) break;
+        }
+        return total;
+    }
+
+    const std::string& expected() const
+    {
+        return d_expected;
+    }
+};
+    
+// FUNCTIONS
+
+// Match the character 'c' and cache it.
+static Parser ch(char c)
+{
+    return ClassParser(CharClass(c, c), std::string("'") + c + "'");
+}
+
+// Match a character in ['lo', 'hi'] and cache it.
+static Parser range(char lo, char hi)
+{
+    return ClassParser(CharClass(lo, hi),
+                       std::string("[") + lo + "-" + hi + "]");
+}
+
+// Match any character of 'chars' and cache it.
+static Parser charset(const std::string& chars)
+{
+    return ClassParser(CharClass(chars), "[" + chars + "]");
+}
+
+// Match any character of 'cls' and cache it.
+static Parser charset(const CharClass& cls)
+{
+    return ClassParser(cls, cls.describe());
+}
+
+// Same as Combinators::star and plus, but a run over a ch, range or
+// charset parser is matched by one vectorized scan.
+static Parser star(Parser parser)
+{
+    if(const ClassParser* cls = parser.template target<ClassParser>())
+    {
+        ClassParser copy(*cls);
+        return
+            [copy](State& state, bool must)->RCode
+            {
+                copy.span(state);
+                return RCode::SUCCESS;
+            };
+    }
+    return Combinators<State>::star(parser);
+}
+
+static Parser plus(Parser parser)
+{
+    if(const ClassParser* cls = parser.template target<ClassParser>())
+    {
+        ClassParser copy(*cls);
+        return
+            [copy](State& state, bool must)->RCode
+            {
+                if(copy.span(state)) return RCode::SUCCESS;
+                return fail(state, must, copy.expected());
+            };
+    }
+    return Combinators<State>::plus(parser);
+}
+
+// Match the string 'str'; the cache is left untouched.
+static Parser literal(const std::string& str)
+{
+    std::string expected = "\"" + str + "\"";
+    return
+        [str, expected](State& state, bool must)->RCode
+        {
+            if(state.fetch(str.size()) >= str.size() &&
+               0 == std::memcmp(state.current(), str.data(), str.size()))
+            {
+                state.advance(str.size());
+                return RCode::SUCCESS;
+            }
+            return fail(state, must, expected);
+        };
+}
+
+// Match the longest of 'words' and cache its index in 'words' as an int.
+// The cost of a match does not depend on the number of words.
+static Parser keywords(const std::vector<std::string>& words)
+{
+    auto trie = std::make_shared<const KeywordTrie>(words);
+    std::string expected("keyword");
+    return
+        [trie, expected](State& state, bool must)->RCode
+        {
+            std::size_t n = state.fetch(trie->maxLength());
+            const char* p = state.current();
+            int id;
+            std::size_t length = trie->match(p, p + n, id);
+            if(length)
+            {
+                state.cache().set(id);
+                state.advance(length);
+                return RCode::SUCCESS;
+            }
+            return fail(state, must, expected);
+        };
+}
+
+// Match 'program' at the current position; the cache is left untouched.
+// All the remaining input is fetched first, so this is meant for States
+// that hold the whole input.
+static Parser program(std::shared_ptr<const Program> program,
+                      const std::string& expected)
+{
+    return
+        [program, expected](State& state, bool must)->RCode
+        {
+            std::size_t n = state.fetch(static_cast<std::size_t>(-1));
+            const char* p = state.current();
+            std::size_t length = program->match(p, p + n);
+            if(Program::k_NO_MATCH != length)
+            {
+                state.advance(length);
+                return RCode::SUCCESS;
+            }
+            return fail(state, must, expected);
+        };
+}
+
+// Match any one character and cache it.
+static Parser any()
+{
+    std::string expected("any character");
+    return
+        [expected](State& state, bool must)->RCode
+        {
+            if(state.fetch(1))
+            {
+                state.cache().set(*state.current());
+                state.advance(1);
+                return RCode::SUCCESS;
+            }
+            return fail(state, must, expected);
+        };
+}
+
+// Report the failure of a leaf parser expecting 'expected': record it
+// if the State tracks failures, else throw ScanError if 'must' is set.
+// A recorded failure returns FAIL even if 'must' is set; a seq failing
+// after its cut turns it into CutFailure.
+// 'expected' must live as long as the parser, as it may be recorded.
+static RCode fail(State& state, bool must, const std::string& expected)
+{
+    return fail(state, must, expected, scanners_impl::HasFailures<State>());
+}
+
+private:
+static RCode fail(State& state,
+                  bool must,
+                  const std::string& expected,
+                  std::true_type)
+{
+    if(FarthestFailure* failures = state.failures())
+    {
+        failures->record(state.getPos(), expected);
+        return RCode::FAIL;
+    }
+    return fail(state, must, expected, std::false_type());
+}
+
+static RCode fail(State& state,
+                  bool must,
+                  const std::string& expected,
+                  std::false_type)
+{
+    if(must)
+    {
+        throw ScanError(state.getPos(), expected);
+    }
+    return RCode::FAIL;
+}
+    
+}; // close struct Scanners
+    
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_SCANNERS_H
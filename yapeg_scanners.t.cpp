@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <yapeg_scanners.h>
+#include <yapeg_bufferstate.h>
+#include <yapeg_combinators.h>
+#include <string>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<BufferState>;
+using Scn = Scanners<BufferState>;
+    
+} // close anonymous namespace
+
+TEST(Scanners, ch)
+{
+    std::string text("ab");
+    BufferState state(text);
+    EXPECT_EQ(Scn::ch('a')(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.cache().get<char>(), 'a');
+    EXPECT_EQ(Scn::ch('a')(state, false), Cbnt::RCode::FAIL);
+    EXPECT_EQ(state.getPos(), 1u);
+    EXPECT_THROW(Scn::ch('a')(state, true), ScanError);
+    EXPECT_EQ(Scn::ch('b')(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(Scn::ch('b')(state, false), Cbnt::RCode::FAIL);
+}
+
+TEST(Scanners, range_charset_any)
+{
+    std::string text("x7_\n");
+    BufferState state(text);
+    Cbnt::Parser p =
+        Cbnt::seq({
+            Scn::range('a', 'z'),
+            Scn::range('0', '9'),
+            Scn::charset("_$"),
+            Scn::any()
+        });
+    EXPECT_EQ(p(state, true), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 4u);
+    EXPECT_EQ(state.cache().get<char>(), '\n');
+    EXPECT_EQ(Scn::any()(state, false), Cbnt::RCode::FAIL);
+
+    state.setPos(0);
+    EXPECT_EQ(Scn::range('0', '9')(state, false), Cbnt::RCode::FAIL);
+    EXPECT_EQ(Scn::charset("_$")(state, false), Cbnt::RCode::FAIL);
+    EXPECT_EQ(state.getPos(), 0u);
+}
+
+TEST(Scanners, literal)
+{
+    std::string text("select * from");
+    BufferState state(text);
+    EXPECT_EQ(Scn::literal("selected")(state, false), Cbnt::RCode::FAIL);
+    EXPECT_EQ(Scn::literal("select")(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 6u);
+
+    try
+    {
+        Scn::literal("from")(state, true);
+        FAIL();
+    }
+    catch(const ScanError& e)
+    {
+        EXPECT_EQ(e.pos(), 6u);
+        EXPECT_EQ(e.expected(), "\"from\"");
+        EXPECT_EQ(std::string(e.what()), "expected \"from\" at 6");
+    }
+}
+
+TEST(Scanners, grammar)
+{
+    // list <- '[' ws (num (ws ',' ws num)*)? ws ']'
+    Cbnt::Parser ws = Cbnt::star(Scn::charset(" \t\n"));
+    std::vector<int> nums;
+    Cbnt::Parser num =
+        [&nums](BufferState& s, bool must)->Cbnt::RCode
+        {
+            std::size_t begin = s.getPos();
+            if(Cbnt::RCode::FAIL ==
+               Cbnt::plus(Scn::range('0', '9'))(s, must))
+            {
+                return Cbnt::RCode::FAIL;
+            }
+            nums.push_back(
+                std::stoi(std::string(s.begin() + begin, s.current())));
+            return Cbnt::RCode::SUCCESS;
+        };
+    Cbnt::Parser list =
+        Cbnt::seq({
+            Scn::ch('['), ws,
+            Cbnt::qmark(
+                Cbnt::seq({
+                    num,
+                    Cbnt::star(Cbnt::seq({ ws, Scn::ch(','), ws, num }))
+                })),
+            ws, Scn::ch(']')
+        });
+
+    std::string text("[ 1, 22 ,\n333 ]");
+    BufferState state(text);
+    EXPECT_EQ(list(state, true), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), text.size());
+    EXPECT_EQ(nums, std::vector<int>({ 1, 22, 333 }));
+
+    std::string bad("[1, x]");
+    state.reset(bad);
+    EXPECT_THROW(list(state, true), ScanError);
+}
+    
+TEST(Scanners, star_plus)
+{
+    std::string text(std::string(40, ' ') + "\t\nident_42 = x");
+    BufferState state(text);
+
+    EXPECT_TRUE(Scn::charset(" \t\n").target<Scn::ClassParser>());
+    Cbnt::Parser ident =
+        Cbnt::seq({
+            Scn::charset(CharClass('a', 'z').add('_')),
+            Scn::star(Scn::charset(CharClass('a', 'z').add('_').add('0', '9')))
+        });
+    Cbnt::Parser p =
+        Cbnt::seq({
+            Scn::star(Scn::charset(" \t\n")),
+            ident,
+            Scn::plus(Scn::ch(' ')),
+            Scn::plus(Scn::ch('=')),
+            Scn::star(Scn::ch('=')),
+            Scn::star(Scn::ch(' ')),
+            Scn::plus(Cbnt::choice({ Scn::ch('x'), Scn::ch('y') }))
+        });
+    EXPECT_EQ(p(state, true), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), text.size());
+
+    state.setPos(0);
+    EXPECT_EQ(Scn::star(Scn::range('a', 'z'))(state, false),
+              Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 0u);
+    EXPECT_EQ(Scn::plus(Scn::range('a', 'z'))(state, false),
+              Cbnt::RCode::FAIL);
+    EXPECT_THROW(Scn::plus(Scn::range('a', 'z'))(state, true), ScanError);
+
+    EXPECT_EQ(Scn::plus(Scn::ch(' '))(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 40u);
+    EXPECT_EQ(state.cache().get<char>(), ' ');
+}
+    
+TEST(Scanners, keywords)
+{
+    Cbnt::Parser kw = Scn::keywords({ "select", "from", "for", "format" });
+    std::string text("formatted for select");
+    BufferState state(text);
+
+    EXPECT_EQ(kw(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 6u);
+    EXPECT_EQ(state.cache().get<int>(), 3);
+    EXPECT_EQ(kw(state, false), Cbnt::RCode::FAIL);
+    EXPECT_THROW(kw(state, true), ScanError);
+    EXPECT_EQ(state.getPos(), 6u);
+
+    state.setPos(10);
+    EXPECT_EQ(kw(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.cache().get<int>(), 2);
+    state.setPos(14);
+    EXPECT_EQ(kw(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.cache().get<int>(), 0);
+    EXPECT_EQ(state.getPos(), text.size());
+}
+    
+} // close namespace yapeg
@@ -0,0 +1,5 @@
+#include <yapeg_static.h>
+
+namespace yapeg {
+
+} // close namespace yapeg
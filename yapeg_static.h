@@ -0,0 +1,371 @@
+#ifndef INCLUDED_YAPEG_STATIC_H
+#define INCLUDED_YAPEG_STATIC_H
+
+#include <yapeg_combinators.h>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace yapeg {
+
+// Compile-time counterpart of Combinators<State>: every combinator is a
+// concrete class template, so a grammar is one type and the calls
+// between its parsers can be inlined.  A parser is any callable
+// 'RCode (State&, bool)', including Combinators<State>::Parser, and
+// toParser bridges a static grammar back to Combinators<State>::Parser.
+template<typename State>
+struct StaticCombinators
+{
+
+// TYPES
+using RCode = typename Combinators<State>::RCode;
+using Parser = typename Combinators<State>::Parser;
+using SavedPos = typename Combinators<State>::SavedPos;
+using Cut = typename Combinators<State>::Cut;
+
+template<std::size_t I>
+using Index = std::integral_constant<std::size_t, I>;
+    
+template<typename P>
+class Normalize
+{
+private:
+    // DATA
+    P d_parser;
+    
+public:
+    // CREATORS
+    explicit Normalize(P parser): d_parser(std::move(parser)) {}
+
+    // ACCESSORS
+    RCode operator() (State& state, bool must) const
+    {
+        SavedPos pos(state);
+        RCode rc = d_parser(state, must);
+        if(RCode::SUCCESS != rc)
+        {
+            pos.rewind(state);
+        }
+        return rc;
+    }
+};
+
+template<typename A, RCode RC>
+class Action
+{
+private:
+    // DATA
+    A d_actor;
+    
+public:
+    // CREATORS
+    explicit Action(A actor): d_actor(std::move(actor)) {}
+
+    // ACCESSORS
+    RCode operator() (State& state, bool must) const
+    {
+        SavedPos pos(state);
+        d_actor(state);
+        pos.rewind(state);
+        return RC;
+    }
+};
+    
+template<typename... P>
+class Seq
+{
+private:
+    // DATA
+    std::tuple<P...> d_parsers;
+
+    // ACCESSORS
+    RCode run(State& state,
+              bool must,
+              SavedPos& pos,
+              Index<sizeof...(P)>) const
+    {
+        return RCode::SUCCESS;
+    }
+
+    template<std::size_t I>
+    RCode run(State& state, bool must, SavedPos& pos, Index<I>) const
+    {
+        return step(std::get<I>(d_parsers), state, must, pos, Index<I>());
+    }
+
+    template<std::size_t I>
+    RCode step(const Cut&,
+               State& state,
+               bool must,
+               SavedPos& pos,
+               Index<I>) const
+    {
+        pos.release();
+        return run(state, true, pos, Index<I+1>());
+    }
+
+    template<typename Q, std::size_t I>
+    RCode step(const Q& parser,
+               State& state,
+               bool must,
+               SavedPos& pos,
+               Index<I>) const
+    {
+        if(RCode::FAIL == parser(state, must))
+        {
+            if(pos.isReleased())
+            {
+                throw CutFailure();
+            }
+            return RCode::FAIL;
+        }
+        return run(state, must, pos, Index<I+1>());
+    }
+    
+public:
+    // CREATORS
+    explicit Seq(P... parsers): d_parsers(std::move(parsers)...) {}
+
+    // ACCESSORS
+    RCode operator() (State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == run(state, must, pos, Index<0>()))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        return RCode::SUCCESS;
+    }
+};
+
+template<typename... P>
+class Choice
+{
+private:
+    // DATA
+    std::tuple<P...> d_parsers;
+
+    // ACCESSORS
+    RCode run(State& state, bool must, Index<sizeof...(P)>) const
+    {
+        return RCode::FAIL;
+    }
+
+    template<std::size_t I>
+    RCode run(State& state, bool must, Index<I>) const
+    {
+        if(RCode::SUCCESS ==
+           std::get<I>(d_parsers)(
+               state, I+1 != sizeof...(P) ? false : must))
+        {
+            return RCode::SUCCESS;
+        }
+        return run(state, must, Index<I+1>());
+    }
+    
+public:
+    // CREATORS
+    explicit Choice(P... parsers): d_parsers(std::move(parsers)...) {}
+
+    // ACCESSORS
+    RCode operator() (State& state, bool must) const
+    {
+        return run(state, must, Index<0>());
+    }
+};
+
+template<typename P>
+class Star
+{
+private:
+    // DATA
+    P d_parser;
+    
+public:
+    // CREATORS
+    explicit Star(P parser): d_parser(std::move(parser)) {}
+
+    // ACCESSORS
+    RCode operator() (State& state, bool must) const
+    {
+        while(RCode::FAIL != d_parser(state, false)) ;
+        return RCode::SUCCESS;
+    }
+};
+
+template<typename P>
+class Plus
+{
+private:
+    // DATA
+    P d_parser;
+    
+public:
+    // CREATORS
+    explicit Plus(P parser): d_parser(std::move(parser)) {}
+
+    // ACCESSORS
+    RCode operator() (State& state, bool must) const
+    {
+        SavedPos pos(state);
+        if(RCode::FAIL == d_parser(state, must))
+        {
+            pos.rewind(state);
+            return RCode::FAIL;
+        }
+        while(RCode::FAIL != d_parser(state, false)) ;
+        return RCode::SUCCESS;
+    }
+};
+
+template<typename P>
+class QMark
+{
+private:
+    // DATA
+    P d_parser;
+    
+public:
+    // CREATORS
+    explicit QMark(P parser): d_parser(std::move(parser)) {}
+
+    // ACCESSORS
+    RCode operator() (State& state, bool must) const
+    {
+        d_parser(state, false);
+        return RCode::SUCCESS;
+    }
+};
+
+template<typename P>
+class PTest
+{
+private:
+    // DATA
+    P d_parser;
+    
+public:
+    // CREATORS
+    explicit PTest(P parser): d_parser(std::move(parser)) {}
+
+    // ACCESSORS
+    RCode operator() (State& state, bool must) const
+    {
+        SavedPos pos(state);
+        RCode rc = d_parser(state, false);
+        pos.rewind(state);
+        return
+            RCode::FAIL == rc ?
+            RCode::FAIL : RCode::SUCCESS;
+    }
+};
+
+template<typename P>
+class NTest
+{
+private:
+    // DATA
+    P d_parser;
+    
+public:
+    // CREATORS
+    explicit NTest(P parser): d_parser(std::move(parser)) {}
+
+    // ACCESSORS
+    RCode operator() (State& state, bool must) const
+    {
+        SavedPos pos(state);
+        RCode rc = d_parser(state, false);
+        pos.rewind(state);
+        return
+            RCode::SUCCESS == rc ?
+            RCode::FAIL : RCode::SUCCESS;
+    }
+};
+    
+// FUNCTIONS
+template<typename P>
+static Normalize<P> normalize(P parser)
+{
+    return Normalize<P>(std::move(parser));
+}
+
+template<typename A>
+static Action<A, RCode::SUCCESS> yaction(A actor)
+{
+    return Action<A, RCode::SUCCESS>(std::move(actor));
+}
+
+template<typename A>
+static Action<A, RCode::FAIL> naction(A actor)
+{
+    return Action<A, RCode::FAIL>(std::move(actor));
+}
+    
+template<typename... P>
+static Seq<P...> seq(P... parsers)
+{
+    return Seq<P...>(std::move(parsers)...);
+}
+
+// Same as Combinators::cut, as an element of seq.
+static Cut cut()
+{
+    return Cut();
+}
+
+template<typename P, typename A>
+static Seq<P, Action<A, RCode::SUCCESS> > combo(P parser, A actor)
+{
+    return seq(std::move(parser), yaction(std::move(actor)));
+}
+    
+template<typename... P>
+static Choice<P...> choice(P... parsers)
+{
+    return Choice<P...>(std::move(parsers)...);
+}
+
+template<typename P>
+static Star<P> star(P parser)
+{
+    return Star<P>(std::move(parser));
+}
+
+template<typename P>
+static Plus<P> plus(P parser)
+{
+    return Plus<P>(std::move(parser));
+}
+
+template<typename P>
+static QMark<P> qmark(P parser)
+{
+    return QMark<P>(std::move(parser));
+}
+
+template<typename P>
+static PTest<P> ptest(P parser)
+{
+    return PTest<P>(std::move(parser));
+}
+
+template<typename P>
+static NTest<P> ntest(P parser)
+{
+    return NTest<P>(std::move(parser));
+}
+
+template<typename P>
+static Parser toParser(P parser)
+{
+    return Parser(std::move(parser));
+}
+    
+}; // close struct StaticCombinators
+    
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_STATIC_H
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <yapeg_static.h>
+#include <yapeg_combinators.h>
+#include <yapeg_any.h>
+#include <stdexcept>
+#include <string>
+#include <cassert>
+
+namespace yapeg {
+
+namespace {
+
+class State
+{
+private:
+    // DATA
+    std::size_t d_pos;
+    std::string d_text;
+    Any d_cache;
+
+public:
+    // CREATORS
+    explicit State(const std::string& text)
+        : d_pos(0)
+        , d_text(text) {}
+
+    // MANIPULATORS
+    void next()
+    {
+        ++d_pos;
+    }
+
+    void setPos(std::size_t pos)
+    {
+        assert(pos <= d_text.size());
+        d_pos = pos;
+    }
+
+    Any& cache() { return d_cache; }
+
+    // ACCESSORS
+    bool isValid() const
+    {
+        return d_pos < d_text.size();
+    }
+
+    char peek() const
+    {
+        assert(d_pos < d_text.size());
+        return d_text[d_pos];
+    }
+
+    std::size_t getPos() const
+    {
+        return d_pos;
+    }
+};
+
+using Stat = StaticCombinators<State>;
+using RCode = Stat::RCode;
+
+class Ch
+{
+private:
+    // DATA
+    char d_c;
+
+public:
+    // CREATORS
+    explicit Ch(char c): d_c(c) {}
+
+    // ACCESSORS
+    RCode operator() (State& s, bool must) const
+    {
+        if(s.isValid() && s.peek() == d_c)
+        {
+            s.cache().set<char>(d_c);
+            s.next();
+            return RCode::SUCCESS;
+        }
+        if(must)
+        {
+            throw std::runtime_error(std::string("expect ") + d_c);
+        }
+        return RCode::FAIL;
+    }
+};
+
+} // close anonymous namespace
+
+TEST(StaticCombinators, seq_choice)
+{
+    auto g =
+        Stat::seq(
+            Ch('a'),
+            Stat::choice(
+                Stat::seq(Ch('b'), Ch('x')),
+                Stat::seq(Ch('b'), Ch('c'))),
+            Ch('d'));
+
+    State s1("abcd");
+    EXPECT_EQ(g(s1, false), RCode::SUCCESS);
+    EXPECT_EQ(s1.getPos(), 4u);
+
+    State s2("abxe");
+    EXPECT_EQ(g(s2, false), RCode::FAIL);
+    EXPECT_EQ(s2.getPos(), 0u);
+}
+
+TEST(StaticCombinators, cut)
+{
+    auto g =
+        Stat::choice(
+            Stat::seq(Ch('a'), Stat::cut(), Ch('b')),
+            Stat::seq(Ch('a'), Ch('c')));
+
+    State s1("ab");
+    EXPECT_EQ(g(s1, false), RCode::SUCCESS);
+    EXPECT_EQ(s1.getPos(), 2u);
+
+    State s2("ac");
+    EXPECT_THROW(g(s2, false), std::runtime_error);
+
+    State s3("c");
+    EXPECT_EQ(g(s3, false), RCode::FAIL);
+    EXPECT_EQ(s3.getPos(), 0u);
+
+    // a failure after the cut that does not throw is still committed
+    State s4("ab");
+    EXPECT_THROW(
+        Stat::choice(
+            Stat::seq(Ch('a'), Stat::cut(), Stat::ntest(Ch('b'))),
+            Stat::seq(Ch('a'), Ch('b')))(s4, false),
+        CutFailure);
+}
+
+TEST(StaticCombinators, star_plus_qmark)
+{
+    std::size_t n = 0;
+    auto g =
+        Stat::seq(
+            Stat::star(Stat::combo(Ch('a'), [&n](State& s) { ++n; })),
+            Stat::plus(Ch('b')),
+            Stat::qmark(Ch('c')),
+            Ch('d'));
+
+    State s1("aaabbd");
+    EXPECT_EQ(g(s1, false), RCode::SUCCESS);
+    EXPECT_EQ(s1.getPos(), 6u);
+    EXPECT_EQ(n, 3u);
+
+    State s2("aad");
+    EXPECT_EQ(g(s2, false), RCode::FAIL);
+    EXPECT_EQ(s2.getPos(), 0u);
+}
+
+TEST(StaticCombinators, ptest_ntest)
+{
+    auto g =
+        Stat::seq(
+            Stat::ptest(Ch('a')),
+            Stat::ntest(Ch('b')),
+            Ch('a'),
+            Stat::naction([](State& s) { s.next(); }));
+
+    State s1("ab");
+    EXPECT_EQ(g(s1, false), RCode::FAIL);
+    EXPECT_EQ(s1.getPos(), 0u);
+
+    State s2("ba");
+    EXPECT_EQ(Stat::ptest(Ch('a'))(s2, false), RCode::FAIL);
+    EXPECT_EQ(Stat::ntest(Ch('a'))(s2, false), RCode::SUCCESS);
+    EXPECT_EQ(s2.getPos(), 0u);
+}
+    
+TEST(StaticCombinators, toParser)
+{
+    using Cbnt = Combinators<State>;
+
+    Cbnt::Parser hot = Stat::toParser(Stat::plus(Ch('a')));
+    Cbnt::Parser g =
+        Cbnt::seq({
+            hot,
+            Stat::toParser(
+                Stat::seq(Stat::normalize(Cbnt::Parser(Ch('b'))), Ch('c'))),
+            Cbnt::yaction(
+                [](State& s) {
+                    EXPECT_EQ(s.cache().get<char>(), 'c');
+                })
+        });
+
+    State s("aabc");
+    EXPECT_EQ(g(s, true), RCode::SUCCESS);
+    EXPECT_EQ(s.getPos(), 4u);
+}
+    
+} // close namespace yapeg
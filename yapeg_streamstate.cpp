@@ -0,0 +1,44 @@
+#include <yapeg_streamstate.h>
+#include <algorithm>
+
+namespace yapeg {
+
+// CREATORS
+StreamState::StreamState(const Reader& reader, std::size_t chunkSize)
+    : d_reader(reader)
+    , d_chunkSize(chunkSize)
+    , d_base(0)
+    , d_pos(0)
+    , d_eof(false)
+    , d_failures(nullptr)
+{
+    assert(chunkSize > 0);
+}
+
+// MANIPULATORS
+void StreamState::release()
+{
+    std::size_t keep = d_pins.empty() ? d_pos : d_pins.front();
+    keep = std::min(keep, d_pos);
+    if(keep == d_base) return;
+    d_buffer.erase(d_buffer.begin(),
+                   d_buffer.begin() + (keep - d_base));
+    d_base = keep;
+    d_memo.eraseBefore(keep);
+}
+
+void StreamState::fill(std::size_t n)
+{
+    release();
+    while(available() < n && !d_eof)
+    {
+        std::size_t size = d_buffer.size();
+        d_buffer.resize(size + d_chunkSize);
+        std::size_t got = d_reader(d_buffer.data() + size, d_chunkSize);
+        assert(got <= d_chunkSize);
+        d_buffer.resize(size + got);
+        d_eof = 0 == got;
+    }
+}
+
+} // close namespace yapeg
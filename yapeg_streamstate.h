@@ -0,0 +1,143 @@
+#ifndef INCLUDED_YAPEG_STREAMSTATE_H
+#define INCLUDED_YAPEG_STREAMSTATE_H
+
+#include <yapeg_any.h>
+#include <yapeg_failure.h>
+#include <yapeg_memo.h>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace yapeg {
+
+// State over input pulled in chunks from a reader.  Positions are byte
+// offsets from the beginning of the stream.  Only the bytes from the
+// oldest position a pinned frame can rewind to (or the current one, if
+// nothing is pinned) are kept; older input and the memo entries there
+// are released whenever more input is read.  Provides the character
+// level interface used by Scanners and the Pin interface of
+// Combinators.
+class StreamState
+{
+public:
+    // TYPES
+
+    // Read up to 'size' bytes into 'buffer' and return how many were
+    // read, 0 at the end of input.
+    using Reader = std::function<std::size_t (char* buffer,
+                                              std::size_t size)>;
+
+    // CONSTANTS
+    enum { k_CHUNK_SIZE = 64 * 1024 };
+
+private:
+    // DATA
+    Reader d_reader;
+    std::size_t d_chunkSize;
+    std::vector<char> d_buffer;       // bytes from d_base on
+    std::size_t d_base;
+    std::size_t d_pos;
+    bool d_eof;
+    std::vector<std::size_t> d_pins;  // in stack order, oldest first
+    Any d_cache;
+    MemoTable<std::size_t> d_memo;
+    FarthestFailure* d_failures;      // not owned, null to throw
+
+    // MANIPULATORS
+
+    // Drop the input and memo entries no frame can rewind to.
+    void release();
+
+    // Release, then read until 'n' bytes are available at current() or
+    // the input ends.
+    void fill(std::size_t n);
+
+public:
+    // CREATORS
+    explicit StreamState(const Reader& reader,
+                         std::size_t chunkSize = k_CHUNK_SIZE);
+    StreamState(const StreamState&) = delete;
+    StreamState& operator= (const StreamState&) = delete;
+
+    // MANIPULATORS
+    void setPos(std::size_t pos)
+    {
+        assert(d_base <= pos && pos <= d_base + d_buffer.size());
+        d_pos = pos;
+    }
+
+    void advance(std::size_t n)
+    {
+        assert(n <= available());
+        d_pos += n;
+    }
+
+    // Return the number of bytes available at current(), which is at
+    // least 'n' unless the input ends first.
+    std::size_t fetch(std::size_t n)
+    {
+        if(available() < n)
+        {
+            fill(n);
+        }
+        return available();
+    }
+
+    void pin(std::size_t pos)
+    {
+        assert(d_base <= pos);
+        d_pins.push_back(pos);
+    }
+
+    void unpin(std::size_t pos)
+    {
+        assert(!d_pins.empty() && d_pins.back() == pos);
+        d_pins.pop_back();
+    }
+
+    Any& cache() { return d_cache; }
+
+    MemoTable<std::size_t>& memoTable() { return d_memo; }
+
+    void trackFailures(FarthestFailure* failures)
+    {
+        d_failures = failures;
+    }
+
+    // ACCESSORS
+    std::size_t getPos() const
+    {
+        return d_pos;
+    }
+
+    const char* current() const
+    {
+        return d_buffer.data() + (d_pos - d_base);
+    }
+
+    std::size_t available() const
+    {
+        return d_buffer.size() - (d_pos - d_base);
+    }
+
+    const Any& cache() const { return d_cache; }
+
+    FarthestFailure* failures() const { return d_failures; }
+
+    // Return the oldest position still buffered.
+    std::size_t base() const
+    {
+        return d_base;
+    }
+
+    // Return the number of bytes buffered.
+    std::size_t buffered() const
+    {
+        return d_buffer.size();
+    }
+};
+
+} // close namespace yapeg
+
+#endif // INCLUDED_YAPEG_STREAMSTATE_H
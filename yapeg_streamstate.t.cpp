@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <yapeg_streamstate.h>
+#include <yapeg_scanners.h>
+#include <yapeg_combinators.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace yapeg {
+
+namespace {
+
+using Cbnt = Combinators<StreamState>;
+using Scn = Scanners<StreamState>;
+
+// Reader over 'text' handing out at most 'step' bytes per call.
+StreamState::Reader stringReader(const std::string& text, std::size_t step)
+{
+    std::size_t offset = 0;
+    return
+        [text, step, offset](char* buffer, std::size_t size) mutable
+        {
+            std::size_t n = std::min(std::min(size, step),
+                                     text.size() - offset);
+            std::memcpy(buffer, text.data() + offset, n);
+            offset += n;
+            return n;
+        };
+}
+
+} // close anonymous namespace
+
+TEST(StreamState, positions)
+{
+    std::string text("hello world");
+    StreamState state(stringReader(text, 3), 4);
+    EXPECT_EQ(state.getPos(), 0u);
+    EXPECT_EQ(state.available(), 0u);
+    EXPECT_GE(state.fetch(1), 1u);
+    EXPECT_EQ(*state.current(), 'h');
+
+    EXPECT_GE(state.fetch(7), 7u);
+    state.advance(6);
+    EXPECT_EQ(*state.current(), 'w');
+    state.setPos(1);
+    EXPECT_EQ(*state.current(), 'e');
+
+    state.setPos(6);
+    EXPECT_EQ(state.fetch(100), 5u);
+    EXPECT_EQ(state.fetch(100), 5u);
+    state.advance(5);
+    EXPECT_EQ(state.fetch(1), 0u);
+    EXPECT_EQ(state.getPos(), text.size());
+}
+
+TEST(StreamState, release)
+{
+    std::string line("alpha beta 42\n");
+    std::string text;
+    for(int i = 0; i < 1000; ++i) text += line;
+    StreamState state(stringReader(text, 16), 16);
+
+    Cbnt::Parser word =
+        Cbnt::choice({
+            Scn::plus(Scn::range('a', 'z')),
+            Scn::plus(Scn::range('0', '9'))
+        });
+    Cbnt::Parser grammar =
+        Cbnt::star(
+            Cbnt::seq({
+                Cbnt::memo(word),
+                Scn::star(Scn::charset(" \n"))
+            }));
+    EXPECT_EQ(grammar(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), text.size());
+    EXPECT_LE(state.buffered(), 64u);
+    EXPECT_LE(state.memoTable().size(), 8u);
+}
+
+TEST(StreamState, pin)
+{
+    std::string text(1000, 'a');
+    text += "b";
+    StreamState state(stringReader(text, 16), 16);
+
+    // the lookahead must keep all of its input to rewind to the start
+    Cbnt::Parser p =
+        Cbnt::seq({
+            Cbnt::ptest(Cbnt::seq({ Scn::star(Scn::ch('a')),
+                                    Scn::ch('b') })),
+            Scn::ch('a')
+        });
+    EXPECT_EQ(p(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 1u);
+    EXPECT_EQ(state.base(), 0u);
+    EXPECT_GE(state.buffered(), text.size());
+
+    state.setPos(0);
+    EXPECT_EQ(Scn::plus(Scn::ch('a'))(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), 1000u);
+
+    // nothing pinned: the next read releases what lies behind
+    EXPECT_EQ(Scn::literal("b")(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.fetch(1), 0u);
+    EXPECT_EQ(state.base(), 1001u);
+    EXPECT_EQ(state.buffered(), 0u);
+}
+
+TEST(StreamState, cut)
+{
+    std::string text;
+    for(int i = 0; i < 1000; ++i) text += "key value;";
+    StreamState state(stringReader(text, 16), 16);
+
+    // without the cut the outer seq would keep all input from 0
+    Cbnt::Parser entry =
+        Cbnt::seq({
+            Scn::literal("key"),
+            Cbnt::cut(),
+            Scn::literal(" value"),
+            Scn::ch(';')
+        });
+    Cbnt::Parser grammar =
+        Cbnt::seq({
+            Cbnt::cut(),
+            Cbnt::star(entry),
+            Cbnt::ntest(Scn::any())
+        });
+    EXPECT_EQ(grammar(state, false), Cbnt::RCode::SUCCESS);
+    EXPECT_EQ(state.getPos(), text.size());
+    EXPECT_LE(state.buffered(), 64u);
+
+    std::string bad("key value;key vaXue;");
+    StreamState badState(stringReader(bad, 4), 4);
+    EXPECT_THROW(grammar(badState, false), ScanError);
+}
+
+} // close namespace yapeg